@@ -8,26 +8,188 @@
 
 #if defined(__linux__)
 #define DB_OS_LINUX
+#include <sys/mman.h>
+#include <unistd.h>
 #endif
 
+// x86 kernels are compiled for each instruction set and picked at runtime
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define DB_SIMD_DISPATCH
+#define DB_TARGET(isa) __attribute__((target(isa)))
+#include <immintrin.h>
+#endif
+
+#include "test_sse_macro.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <climits>
 #include <cstddef>
+#include <cstdint>
+#include <cstdlib>
 #include <cstring>
+#include <functional>
 #include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory_resource>
 #include <memory>
+#include <new>
+#include <numeric>
+#include <stdexcept>
+#include <string>
 #include <type_traits>
+#include <utility>
+#if __cplusplus > 201703L && __has_include(<compare>)
+#include <compare>
+#endif
 
 
 namespace ok
 {
 
     template<size_t N>
-    size_t ceil_div(size_t n)
+    constexpr size_t ceil_div(size_t n)
     {
         return (n % N == 0 ? n / N : n / N + 1);
     }
 
 
+    // Bit order policies : where bit i lives inside block i / bits_per_block
+    struct lsb_first {}; // bit i is (block >> i % bits_per_block) & 1, as integer shifts and tzcnt see it
+    struct msb_first {}; // bit i is counted from the most significant bit of its block
+
+
+    // Growth policies : next_capacity(capacity, required) gives the capacity in bits to reallocate
+    // to when required bits do not fit. The result is clamped to [required, max_size()].
+    template<size_t Num = 3, size_t Den = 2>
+    struct geometric_growth
+    {
+        static_assert(Num > Den && Den > 0, "The growth factor must be greater than one");
+
+        static constexpr size_t next_capacity(size_t capacity, size_t required) noexcept
+        {
+            const size_t extra = capacity / Den * (Num - Den) + capacity % Den * (Num - Den) / Den + 1;
+            return capacity > std::numeric_limits<size_t>::max() - extra ? required : std::max(capacity + extra, required);
+        }
+    };
+
+    // Rounds the capacity given by Base up to whole pages, for page-backed allocators
+    template<size_t PageSize = 4096, typename Base = geometric_growth<>>
+    struct page_growth
+    {
+        static constexpr size_t next_capacity(size_t capacity, size_t required) noexcept
+        {
+            constexpr size_t page_bits = PageSize * CHAR_BIT;
+            const size_t target = Base::next_capacity(capacity, required);
+            return target > std::numeric_limits<size_t>::max() - page_bits ? target : (target + page_bits - 1) / page_bits * page_bits;
+        }
+    };
+
+    // Never over-allocates, every growth reallocates unless the allocator expands in place
+    struct exact_growth
+    {
+        static constexpr size_t next_capacity(size_t, size_t required) noexcept { return required; }
+    };
+
+
+    // Allocator on top of calloc, which gets large zeroed blocks from the system without clearing them
+    template<typename T>
+    struct calloc_allocator
+    {
+        static_assert(alignof(T) <= alignof(std::max_align_t), "calloc does not align beyond max_align_t");
+
+        using value_type = T;
+        using is_always_equal = std::true_type;
+
+        calloc_allocator() = default;
+        template<typename U>
+        calloc_allocator(calloc_allocator<U> const&) noexcept {}
+
+        T* allocate(size_t n)
+        {
+            void* p = std::malloc(n * sizeof(T));
+            if(p == nullptr && n != 0)
+                throw std::bad_alloc();
+            return static_cast<T*>(p);
+        }
+
+        T* allocate_zeroed(size_t n)
+        {
+            void* p = std::calloc(n, sizeof(T));
+            if(p == nullptr && n != 0)
+                throw std::bad_alloc();
+            return static_cast<T*>(p);
+        }
+
+        void deallocate(T* p, size_t) noexcept { std::free(p); }
+
+        friend bool operator==(calloc_allocator const&, calloc_allocator const&) noexcept { return true; }
+        friend bool operator!=(calloc_allocator const&, calloc_allocator const&) noexcept { return false; }
+    };
+
+#ifdef DB_OS_LINUX
+    // Allocator giving each allocation its own anonymous mapping, that mremap grows without copying.
+    // Every allocation takes whole pages, it is meant for huge bitsets.
+    template<typename T>
+    struct mmap_allocator
+    {
+        using value_type = T;
+        using is_always_equal = std::true_type;
+
+        mmap_allocator() = default;
+        template<typename U>
+        mmap_allocator(mmap_allocator<U> const&) noexcept {}
+
+        T* allocate(size_t n)
+        {
+            void* p = ::mmap(nullptr, bytes(n), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if(p == MAP_FAILED)
+                throw std::bad_alloc();
+            return static_cast<T*>(p);
+        }
+
+        // Fresh anonymous pages are zero, and only get backed by memory once written
+        T* allocate_zeroed(size_t n) { return allocate(n); }
+
+        void deallocate(T* p, size_t n) noexcept { ::munmap(p, bytes(n)); }
+
+        T* try_reallocate(T* p, size_t n, size_t new_n) noexcept
+        {
+            void* q = ::mremap(p, bytes(n), bytes(new_n), MREMAP_MAYMOVE);
+            return q == MAP_FAILED ? nullptr : static_cast<T*>(q);
+        }
+
+        friend bool operator==(mmap_allocator const&, mmap_allocator const&) noexcept { return true; }
+        friend bool operator!=(mmap_allocator const&, mmap_allocator const&) noexcept { return false; }
+
+    private:
+        static size_t bytes(size_t n) noexcept
+        {
+            static const size_t page = size_t(::sysconf(_SC_PAGESIZE));
+            return std::max<size_t>(1, (n * sizeof(T) + page - 1) / page) * page;
+        }
+    };
+#endif
+
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    class DynamicBitset;
+
+    // Truth tables of the apply3 operands, combined with bitwise operators into the truth table of
+    // any three-input function : (a & b) | ~c is truth_table::a & truth_table::b | uint8_t(~truth_table::c)
+    struct truth_table
+    {
+        static constexpr uint8_t a = 0xF0;
+        static constexpr uint8_t b = 0xCC;
+        static constexpr uint8_t c = 0xAA;
+    };
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void apply3(DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>& dst, DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy> const& a, DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy> const& b, DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy> const& c, uint8_t table);
+
+
     namespace detail
     {
         template<typename Iter>
@@ -38,922 +200,3912 @@ namespace ok
 
         template<typename Iter>
         static constexpr bool is_input_iterator_v = is_input_iterator<Iter>::value;
-    };
 
+        template<typename Iter>
+        static constexpr bool is_forward_iterator_v = std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<Iter>::iterator_category>;
 
-    template<typename Allocator = std::allocator<std::byte>>
-    class DynamicBitset : private Allocator
-    {
-        template<bool is_const>
-        struct internal_pointer;
-    public:
-        using value_type = bool;
-        using allocator_type = Allocator;
-        using size_type = uintptr_t;
-        using difference_type = std::ptrdiff_t;
+        // Allocators may provide try_reallocate(p, n, new_n) : it resizes the allocation of p to new_n
+        // elements without copying them, possibly moving it, and returns nullptr when it can not
+        template<typename Alloc, typename = void>
+        struct has_try_reallocate : std::false_type {};
 
-        struct reference
+        template<typename Alloc>
+        struct has_try_reallocate<Alloc, std::void_t<decltype(std::declval<Alloc&>().try_reallocate(
+            std::declval<typename std::allocator_traits<Alloc>::pointer>(), size_t(), size_t()))>> : std::true_type {};
+
+        // Allocators may provide allocate_zeroed(n), whose memory reads as zero without being written
+        template<typename Alloc, typename = void>
+        struct has_allocate_zeroed : std::false_type {};
+
+        template<typename Alloc>
+        struct has_allocate_zeroed<Alloc, std::void_t<decltype(std::declval<Alloc&>().allocate_zeroed(size_t()))>> : std::true_type {};
+
+        template<typename Order, typename Block>
+        struct bit_order;
+
+        template<typename Block>
+        struct bit_order<lsb_first, Block>
         {
-            reference(std::byte* ptr, uint8_t off) noexcept;
+            static constexpr size_t bits = sizeof(Block) * CHAR_BIT;
+
+            static constexpr Block bit(size_t offset) noexcept { return Block(Block(1) << offset); }
+            // Mask of the bits of index lower than n
+            static constexpr Block head(size_t n) noexcept { return n >= bits ? Block(~Block(0)) : Block((Block(1) << n) - 1); }
+            // Moves bit i + n to i, resp. bit i to i + n, for n < bits
+            static constexpr Block shift_down(Block b, size_t n) noexcept { return Block(b >> n); }
+            static constexpr Block shift_up(Block b, size_t n) noexcept { return Block(b << n); }
+            // Offset of the first, resp. last, set bit of b != 0
+            static size_t first(Block b) noexcept;
+            static size_t last(Block b) noexcept;
+        };
 
-            reference& operator=(bool) noexcept;
+        template<typename Block>
+        struct bit_order<msb_first, Block>
+        {
+            static constexpr size_t bits = sizeof(Block) * CHAR_BIT;
+
+            static constexpr Block bit(size_t offset) noexcept { return Block(Block(1) << (bits - 1 - offset)); }
+            static constexpr Block head(size_t n) noexcept { return n == 0 ? Block(0) : Block(Block(~Block(0)) << (bits - n)); }
+            static constexpr Block shift_down(Block b, size_t n) noexcept { return Block(b << n); }
+            static constexpr Block shift_up(Block b, size_t n) noexcept { return Block(b >> n); }
+            static size_t first(Block b) noexcept;
+            static size_t last(Block b) noexcept;
+        };
 
-            reference& operator=(reference const&) noexcept;
+        // Allocation unit of bitsets aligned on more than a block : one SIMD vector worth of blocks
+        template<typename Block, size_t Alignment>
+        struct alignas(Alignment) aligned_vector
+        {
+            Block blocks[Alignment / sizeof(Block)];
+        };
 
-            void flip() noexcept;
+        template<typename Block>
+        unsigned popcount(Block b) noexcept
+        {
+            static_assert(sizeof(Block) <= sizeof(unsigned long long), "Block is wider than any popcount instruction");
+            #ifdef DB_OS_WINDOWS
+            #if defined(_M_X64) || defined(_M_ARM64)
+            return static_cast<unsigned>(__popcnt64(static_cast<unsigned __int64>(b)));
+            #else
+            return __popcnt(static_cast<unsigned int>(b)) + __popcnt(static_cast<unsigned int>(static_cast<unsigned long long>(b) >> 32));
+            #endif
+            #elif defined(DB_OS_LINUX)
+            return static_cast<unsigned>(__builtin_popcountll(static_cast<unsigned long long>(b)));
+            #else
+            unsigned sum = 0;
+            for(; b; b &= b - 1)
+                ++sum;
+            return sum;
+            #endif
+        }
 
-            internal_pointer<false> operator&();
+        // Number of zero bits below the lowest, resp. above the highest, set bit of b != 0
+        template<typename Block>
+        unsigned countr_zero(Block b) noexcept
+        {
+            static_assert(sizeof(Block) <= sizeof(unsigned long long), "Block is wider than any bit scan instruction");
+            #ifdef DB_OS_WINDOWS
+            unsigned long index;
+            #if defined(_M_X64) || defined(_M_ARM64)
+            _BitScanForward64(&index, static_cast<unsigned __int64>(b));
+            #else
+            if(!_BitScanForward(&index, static_cast<unsigned long>(b)))
+            {
+                _BitScanForward(&index, static_cast<unsigned long>(static_cast<unsigned long long>(b) >> 32));
+                index += 32;
+            }
+            #endif
+            return static_cast<unsigned>(index);
+            #elif defined(__GNUC__) || defined(__clang__)
+            return static_cast<unsigned>(__builtin_ctzll(static_cast<unsigned long long>(b)));
+            #else
+            unsigned n = 0;
+            for(; (b & 1) == 0; b >>= 1)
+                ++n;
+            return n;
+            #endif
+        }
 
-            operator bool() const noexcept;
+        template<typename Block>
+        unsigned countl_zero(Block b) noexcept
+        {
+            static_assert(sizeof(Block) <= sizeof(unsigned long long), "Block is wider than any bit scan instruction");
+            constexpr unsigned unused = unsigned(sizeof(unsigned long long) - sizeof(Block)) * CHAR_BIT;
+            #ifdef DB_OS_WINDOWS
+            unsigned long index;
+            #if defined(_M_X64) || defined(_M_ARM64)
+            _BitScanReverse64(&index, static_cast<unsigned __int64>(b));
+            #else
+            if(_BitScanReverse(&index, static_cast<unsigned long>(static_cast<unsigned long long>(b) >> 32)))
+                index += 32;
+            else
+                _BitScanReverse(&index, static_cast<unsigned long>(b));
+            #endif
+            return 63 - static_cast<unsigned>(index) - unused;
+            #elif defined(__GNUC__) || defined(__clang__)
+            return static_cast<unsigned>(__builtin_clzll(static_cast<unsigned long long>(b))) - unused;
+            #else
+            unsigned n = 0;
+            for(Block top = Block(Block(1) << (sizeof(Block) * CHAR_BIT - 1)); (b & top) == 0; b = Block(b << 1))
+                ++n;
+            return n;
+            #endif
+        }
 
-            bool operator==(reference const& other) const { return bool(*this) == bool(other); }
+        template<typename Block>
+        size_t bit_order<lsb_first, Block>::first(Block b) noexcept { return countr_zero(b); }
 
-            bool operator<(reference const& other) const { return !bool(*this) && bool(other); }
+        template<typename Block>
+        size_t bit_order<lsb_first, Block>::last(Block b) noexcept { return bits - 1 - countl_zero(b); }
 
-            friend void swap(reference a, reference b)
+        template<typename Block>
+        size_t bit_order<msb_first, Block>::first(Block b) noexcept { return countl_zero(b); }
+
+        template<typename Block>
+        size_t bit_order<msb_first, Block>::last(Block b) noexcept { return bits - 1 - countr_zero(b); }
+
+        // Folded 64 x 64 -> 128 bit product, the mixing step of the hashes
+        inline uint64_t multiply_mix(uint64_t a, uint64_t b) noexcept
+        {
+            #if defined(__SIZEOF_INT128__)
+            const unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+            return uint64_t(product) ^ uint64_t(product >> 64);
+            #elif defined(DB_OS_WINDOWS) && defined(_M_X64)
+            uint64_t high;
+            const uint64_t low = _umul128(a, b, &high);
+            return low ^ high;
+            #else
+            const uint64_t a_low = a & 0xFFFFFFFF, a_high = a >> 32, b_low = b & 0xFFFFFFFF, b_high = b >> 32;
+            const uint64_t low_low = a_low * b_low, low_high = a_low * b_high, high_low = a_high * b_low;
+            const uint64_t middle = (low_low >> 32) + (low_high & 0xFFFFFFFF) + (high_low & 0xFFFFFFFF);
+            const uint64_t low = (low_low & 0xFFFFFFFF) | (middle << 32);
+            const uint64_t high = a_high * b_high + (low_high >> 32) + (high_low >> 32) + (middle >> 32);
+            return low ^ high;
+            #endif
+        }
+
+        // Key of the j-th chunk : a Weyl sequence, made odd so that no key is zero
+        constexpr uint64_t hash_key(uint64_t j) noexcept { return (0xa0761d6478bd642f + j * 0x9e3779b97f4a7c15) | 1; }
+
+        // Mix of the j-th 8-byte chunk of n bytes, zero-extended past n. A zero chunk mixes to zero,
+        // so that trailing zero bytes leave the XOR of all chunks unchanged.
+        inline uint64_t hash_chunk(std::byte const* p, size_t n, size_t j) noexcept
+        {
+            uint64_t chunk = 0;
+            if(j * 8 < n)
+                std::memcpy(&chunk, p + j * 8, std::min<size_t>(n - j * 8, 8));
+            return multiply_mix(chunk, hash_key(j));
+        }
+
+        // XOR of hash_chunk over all chunks : whole words first, into four sums so that the
+        // multiplies overlap, then the partial tail once
+        inline uint64_t hash_chunks(std::byte const* p, size_t n) noexcept
+        {
+            const auto mix = [p](size_t j)
             {
-                bool temp = a;
-                a = b;
-                b = temp;
+                uint64_t chunk;
+                std::memcpy(&chunk, p + j * 8, 8);
+                return multiply_mix(chunk, hash_key(j));
+            };
+            const size_t whole = n / 8;
+            uint64_t sum[4] = {};
+            size_t j = 0;
+            for(; j + 4 <= whole; j += 4)
+            {
+                sum[0] ^= mix(j);
+                sum[1] ^= mix(j + 1);
+                sum[2] ^= mix(j + 2);
+                sum[3] ^= mix(j + 3);
             }
+            for(; j < whole; ++j)
+                sum[0] ^= mix(j);
+            if(n % 8 != 0)
+                sum[0] ^= hash_chunk(p, n, whole);
+            return sum[0] ^ sum[1] ^ sum[2] ^ sum[3];
+        }
 
-        private:
-            std::byte* const byte;
-            uint8_t const offset;
-        };
+        inline size_t hash_finish(uint64_t sum, size_t size) noexcept
+        {
+            return size_t(multiply_mix(sum ^ 0xe7037ed1a0b428db, size ^ 0x8ebc6af09c88c6e3));
+        }
 
-        using const_reference = bool;
+        // Sets the n bits starting at bit pos of the block array to value
+        template<typename Order, typename Block>
+        void fill_bits(Block* blocks, size_t pos, size_t n, bool value) noexcept
+        {
+            using order = bit_order<Order, Block>;
+            constexpr size_t bits = order::bits;
 
-    private:
-        template<bool is_const>
-        struct internal_pointer
+            if(n == 0)
+                return;
+
+            const Block fill = value ? Block(~Block(0)) : Block(0);
+            blocks += pos / bits;
+            size_t last = pos % bits + n;
+
+            if(last <= bits)
+            {
+                const Block mask = Block(order::head(last) & ~order::head(pos % bits));
+                *blocks = Block((*blocks & ~mask) | (fill & mask));
+                return;
+            }
+
+            const Block mask = Block(~order::head(pos % bits));
+            *blocks = Block((*blocks & ~mask) | (fill & mask));
+            ++blocks;
+            last -= bits;
+            blocks = std::fill_n(blocks, last / bits, fill);
+            if(last % bits != 0)
+                *blocks = Block((*blocks & ~order::head(last % bits)) | (fill & order::head(last % bits)));
+        }
+
+        // Word kernels on raw block memory : they only see bytes, so one instantiation serves every Block type
+        namespace simd
         {
-            friend DynamicBitset;
+            struct and_op
+            {
+                template<typename T>
+                static constexpr T scalar(T a, T b) noexcept { return T(a & b); }
+                #ifdef DB_SIMD_DISPATCH
+                DB_TARGET("sse2") static __m128i sse2(__m128i a, __m128i b) noexcept { return _mm_and_si128(a, b); }
+                DB_TARGET("avx2") static __m256i avx2(__m256i a, __m256i b) noexcept { return _mm256_and_si256(a, b); }
+                DB_TARGET("avx512f") static __m512i avx512(__m512i a, __m512i b) noexcept { return _mm512_and_si512(a, b); }
+                #endif
+            };
+
+            struct or_op
+            {
+                template<typename T>
+                static constexpr T scalar(T a, T b) noexcept { return T(a | b); }
+                #ifdef DB_SIMD_DISPATCH
+                DB_TARGET("sse2") static __m128i sse2(__m128i a, __m128i b) noexcept { return _mm_or_si128(a, b); }
+                DB_TARGET("avx2") static __m256i avx2(__m256i a, __m256i b) noexcept { return _mm256_or_si256(a, b); }
+                DB_TARGET("avx512f") static __m512i avx512(__m512i a, __m512i b) noexcept { return _mm512_or_si512(a, b); }
+                #endif
+            };
+
+            struct xor_op
+            {
+                template<typename T>
+                static constexpr T scalar(T a, T b) noexcept { return T(a ^ b); }
+                #ifdef DB_SIMD_DISPATCH
+                DB_TARGET("sse2") static __m128i sse2(__m128i a, __m128i b) noexcept { return _mm_xor_si128(a, b); }
+                DB_TARGET("avx2") static __m256i avx2(__m256i a, __m256i b) noexcept { return _mm256_xor_si256(a, b); }
+                DB_TARGET("avx512f") static __m512i avx512(__m512i a, __m512i b) noexcept { return _mm512_xor_si512(a, b); }
+                #endif
+            };
+
+            struct and_not_op
+            {
+                template<typename T>
+                static constexpr T scalar(T a, T b) noexcept { return T(a & ~b); }
+                #ifdef DB_SIMD_DISPATCH
+                DB_TARGET("sse2") static __m128i sse2(__m128i a, __m128i b) noexcept { return _mm_andnot_si128(b, a); }
+                DB_TARGET("avx2") static __m256i avx2(__m256i a, __m256i b) noexcept { return _mm256_andnot_si256(b, a); }
+                DB_TARGET("avx512f") static __m512i avx512(__m512i a, __m512i b) noexcept { return _mm512_ternarylogic_epi64(a, b, b, 0x30); }
+                #endif
+            };
+
+            struct nand_op
+            {
+                template<typename T>
+                static constexpr T scalar(T a, T b) noexcept { return T(~(a & b)); }
+                #ifdef DB_SIMD_DISPATCH
+                DB_TARGET("sse2") static __m128i sse2(__m128i a, __m128i b) noexcept { return _mm_xor_si128(_mm_and_si128(a, b), _mm_set1_epi32(-1)); }
+                DB_TARGET("avx2") static __m256i avx2(__m256i a, __m256i b) noexcept { return _mm256_xor_si256(_mm256_and_si256(a, b), _mm256_set1_epi32(-1)); }
+                DB_TARGET("avx512f") static __m512i avx512(__m512i a, __m512i b) noexcept { return _mm512_ternarylogic_epi64(a, b, b, 0x3F); }
+                #endif
+            };
+
+            struct nor_op
+            {
+                template<typename T>
+                static constexpr T scalar(T a, T b) noexcept { return T(~(a | b)); }
+                #ifdef DB_SIMD_DISPATCH
+                DB_TARGET("sse2") static __m128i sse2(__m128i a, __m128i b) noexcept { return _mm_xor_si128(_mm_or_si128(a, b), _mm_set1_epi32(-1)); }
+                DB_TARGET("avx2") static __m256i avx2(__m256i a, __m256i b) noexcept { return _mm256_xor_si256(_mm256_or_si256(a, b), _mm256_set1_epi32(-1)); }
+                DB_TARGET("avx512f") static __m512i avx512(__m512i a, __m512i b) noexcept { return _mm512_ternarylogic_epi64(a, b, b, 0x03); }
+                #endif
+            };
+
+            struct xnor_op
+            {
+                template<typename T>
+                static constexpr T scalar(T a, T b) noexcept { return T(~(a ^ b)); }
+                #ifdef DB_SIMD_DISPATCH
+                DB_TARGET("sse2") static __m128i sse2(__m128i a, __m128i b) noexcept { return _mm_xor_si128(_mm_xor_si128(a, b), _mm_set1_epi32(-1)); }
+                DB_TARGET("avx2") static __m256i avx2(__m256i a, __m256i b) noexcept { return _mm256_xor_si256(_mm256_xor_si256(a, b), _mm256_set1_epi32(-1)); }
+                DB_TARGET("avx512f") static __m512i avx512(__m512i a, __m512i b) noexcept { return _mm512_ternarylogic_epi64(a, b, b, 0xC3); }
+                #endif
+            };
+
+            #ifdef DB_SIMD_DISPATCH
+            // Vector loads and stores of kernels whose pointers are aligned on Align bytes
+            template<size_t Align>
+            DB_TARGET("sse2") __m128i load(std::byte const* p, __m128i) noexcept
+            {
+                if constexpr(Align >= 16)
+                    return _mm_load_si128(reinterpret_cast<__m128i const*>(p));
+                else
+                    return _mm_loadu_si128(reinterpret_cast<__m128i const*>(p));
+            }
 
-            using iterator_category = std::random_access_iterator_tag;
-            using value_type = bool;
-            using reference = std::conditional_t<is_const, typename DynamicBitset<Allocator>::reference const, typename DynamicBitset<Allocator>::reference>;
-            using const_reference = bool;
-            using pointer = internal_pointer;
-            using const_pointer = typename DynamicBitset<Allocator>::template internal_pointer<true>;
-            using difference_type = typename DynamicBitset<Allocator>::difference_type;
-            using size_type = typename DynamicBitset<Allocator>::size_type;
+            template<size_t Align>
+            DB_TARGET("avx2") __m256i load(std::byte const* p, __m256i) noexcept
+            {
+                if constexpr(Align >= 32)
+                    return _mm256_load_si256(reinterpret_cast<__m256i const*>(p));
+                else
+                    return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p));
+            }
 
-            internal_pointer() = default;
+            template<size_t Align>
+            DB_TARGET("avx512f") __m512i load(std::byte const* p, __m512i) noexcept
+            {
+                if constexpr(Align >= 64)
+                    return _mm512_load_si512(p);
+                else
+                    return _mm512_loadu_si512(p);
+            }
 
-            internal_pointer(std::byte* ptr, uint8_t off) noexcept;
+            template<size_t Align>
+            DB_TARGET("sse2") void store(std::byte* p, __m128i v) noexcept
+            {
+                if constexpr(Align >= 16)
+                    _mm_store_si128(reinterpret_cast<__m128i*>(p), v);
+                else
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);
+            }
 
-            internal_pointer(internal_pointer<false> const& other);
+            template<size_t Align>
+            DB_TARGET("avx2") void store(std::byte* p, __m256i v) noexcept
+            {
+                if constexpr(Align >= 32)
+                    _mm256_store_si256(reinterpret_cast<__m256i*>(p), v);
+                else
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+            }
 
-            internal_pointer& operator++()
+            template<size_t Align>
+            DB_TARGET("avx512f") void store(std::byte* p, __m512i v) noexcept
+            {
+                if constexpr(Align >= 64)
+                    _mm512_store_si512(p, v);
+                else
+                    _mm512_storeu_si512(p, v);
+            }
+            #endif
+
+            // dst[i] = Op(dst[i], src[i]) for n bytes, dst and src are either equal or disjoint.
+            // The Align variants take pointers aligned on Align bytes and n a multiple of Align : the
+            // vectors at most Align wide use aligned loads, and no tail is left when Align is the width.
+            using binary_kernel = void (*)(std::byte*, std::byte const*, size_t) noexcept;
+
+            template<typename Op>
+            void binary_scalar(std::byte* dst, std::byte const* src, size_t n) noexcept
             {
-                if(offset == 7)
+                size_t i = 0;
+                for(; i + sizeof(uint64_t) <= n; i += sizeof(uint64_t))
                 {
-                    ++byte;
-                    offset = 0;
+                    uint64_t a, b;
+                    std::memcpy(&a, dst + i, sizeof(a));
+                    std::memcpy(&b, src + i, sizeof(b));
+                    a = Op::scalar(a, b);
+                    std::memcpy(dst + i, &a, sizeof(a));
                 }
-                else ++offset;
-                return *this;
+                for(; i < n; ++i)
+                    dst[i] = std::byte(Op::scalar(uint8_t(dst[i]), uint8_t(src[i])));
             }
 
-            internal_pointer operator++(int)
+            #ifdef DB_SIMD_DISPATCH
+            template<typename Op, size_t Align = 1>
+            DB_TARGET("sse2") void binary_sse2(std::byte* dst, std::byte const* src, size_t n) noexcept
             {
-                auto temp = *this;
-                ++*this;
-                return temp;
+                size_t i = 0;
+                for(; i + 16 <= n; i += 16)
+                {
+                    const __m128i a = load<Align>(dst + i, __m128i());
+                    const __m128i b = load<Align>(src + i, __m128i());
+                    store<Align>(dst + i, Op::sse2(a, b));
+                }
+                if(Align < 16 && i < n)
+                    binary_scalar<Op>(dst + i, src + i, n - i);
             }
 
-            internal_pointer& operator--()
+            template<typename Op, size_t Align = 1>
+            DB_TARGET("avx2") void binary_avx2(std::byte* dst, std::byte const* src, size_t n) noexcept
             {
-                if(offset == 0)
+                size_t i = 0;
+                for(; i + 32 <= n; i += 32)
                 {
-                    --byte;
-                    offset = 7;
+                    const __m256i a = load<Align>(dst + i, __m256i());
+                    const __m256i b = load<Align>(src + i, __m256i());
+                    store<Align>(dst + i, Op::avx2(a, b));
                 }
-                else --offset;
-                return *this;
+                if(Align < 32 && i < n)
+                    binary_sse2<Op, Align>(dst + i, src + i, n - i);
             }
 
-            internal_pointer operator--(int)
+            template<typename Op, size_t Align = 1>
+            DB_TARGET("avx512f") void binary_avx512(std::byte* dst, std::byte const* src, size_t n) noexcept
             {
-                auto temp = *this;
-                --*this;
-                return temp;
+                size_t i = 0;
+                for(; i + 64 <= n; i += 64)
+                {
+                    const __m512i a = load<Align>(dst + i, __m512i());
+                    const __m512i b = load<Align>(src + i, __m512i());
+                    store<Align>(dst + i, Op::avx512(a, b));
+                }
+                if(Align < 64 && i < n)
+                    binary_avx2<Op, Align>(dst + i, src + i, n - i);
             }
+            #endif
 
-            internal_pointer& operator+=(difference_type d);
-
-            internal_pointer& operator-=(difference_type d);
+            // dst[i] = f(a[i], b[i], c[i]) for n bytes, where bit (a << 2 | b << 1 | c) of the truth table
+            // gives f for those inputs, as for vpternlog. dst is equal to or disjoint from each operand
+            using ternary_kernel = void (*)(std::byte*, std::byte const*, std::byte const*, std::byte const*, size_t, uint8_t) noexcept;
 
-            internal_pointer operator+(difference_type d) const;
+            // Shannon expansion on c, b then a; select(x, y, z) is x ? y : z bitwise
+            template<typename T>
+            T ternary_word(T a, T b, T c, uint8_t table) noexcept
+            {
+                const auto mask = [table](int bit) { return (table >> bit) & 1 ? T(~T(0)) : T(0); };
+                const auto select = [](T x, T y, T z) { return T(z ^ (x & (y ^ z))); };
+                const T f0 = select(b, select(c, mask(3), mask(2)), select(c, mask(1), mask(0)));
+                const T f1 = select(b, select(c, mask(7), mask(6)), select(c, mask(5), mask(4)));
+                return select(a, f1, f0);
+            }
 
-            internal_pointer operator-(difference_type d) const;
+            inline void ternary_scalar(std::byte* dst, std::byte const* a, std::byte const* b, std::byte const* c,
+                                       size_t n, uint8_t table) noexcept
+            {
+                size_t i = 0;
+                for(; i + sizeof(uint64_t) <= n; i += sizeof(uint64_t))
+                {
+                    uint64_t x, y, z;
+                    std::memcpy(&x, a + i, sizeof(x));
+                    std::memcpy(&y, b + i, sizeof(y));
+                    std::memcpy(&z, c + i, sizeof(z));
+                    x = ternary_word(x, y, z, table);
+                    std::memcpy(dst + i, &x, sizeof(x));
+                }
+                for(; i < n; ++i)
+                    dst[i] = std::byte(ternary_word(uint8_t(a[i]), uint8_t(b[i]), uint8_t(c[i]), table));
+            }
 
-            reference operator*() { return reference(byte, offset); }
+            #ifdef DB_SIMD_DISPATCH
+            DB_TARGET("sse2") inline __m128i select(__m128i x, __m128i y, __m128i z) noexcept
+            {
+                return _mm_xor_si128(z, _mm_and_si128(x, _mm_xor_si128(y, z)));
+            }
 
-            const_reference operator*() const { return static_cast<bool>(reference(byte, offset)); }
+            DB_TARGET("avx2") inline __m256i select(__m256i x, __m256i y, __m256i z) noexcept
+            {
+                return _mm256_xor_si256(z, _mm256_and_si256(x, _mm256_xor_si256(y, z)));
+            }
 
-            reference operator[](difference_type d) const { return *(*this + d); }
+            template<size_t Align = 1>
+            DB_TARGET("sse2") void ternary_sse2(std::byte* dst, std::byte const* a, std::byte const* b,
+                                                std::byte const* c, size_t n, uint8_t table) noexcept
+            {
+                __m128i m[8];
+                for(int k = 0; k < 8; ++k)
+                    m[k] = _mm_set1_epi8((table >> k) & 1 ? char(-1) : char(0));
+                size_t i = 0;
+                for(; i + 16 <= n; i += 16)
+                {
+                    const __m128i x = load<Align>(a + i, __m128i());
+                    const __m128i y = load<Align>(b + i, __m128i());
+                    const __m128i z = load<Align>(c + i, __m128i());
+                    const __m128i f0 = select(y, select(z, m[3], m[2]), select(z, m[1], m[0]));
+                    const __m128i f1 = select(y, select(z, m[7], m[6]), select(z, m[5], m[4]));
+                    store<Align>(dst + i, select(x, f1, f0));
+                }
+                if(Align < 16 && i < n)
+                    ternary_scalar(dst + i, a + i, b + i, c + i, n - i, table);
+            }
 
-            //const_reference operator[](difference_type d) const { return *(*this + d); }
+            template<size_t Align = 1>
+            DB_TARGET("avx2") void ternary_avx2(std::byte* dst, std::byte const* a, std::byte const* b,
+                                                std::byte const* c, size_t n, uint8_t table) noexcept
+            {
+                __m256i m[8];
+                for(int k = 0; k < 8; ++k)
+                    m[k] = _mm256_set1_epi8((table >> k) & 1 ? char(-1) : char(0));
+                size_t i = 0;
+                for(; i + 32 <= n; i += 32)
+                {
+                    const __m256i x = load<Align>(a + i, __m256i());
+                    const __m256i y = load<Align>(b + i, __m256i());
+                    const __m256i z = load<Align>(c + i, __m256i());
+                    const __m256i f0 = select(y, select(z, m[3], m[2]), select(z, m[1], m[0]));
+                    const __m256i f1 = select(y, select(z, m[7], m[6]), select(z, m[5], m[4]));
+                    store<Align>(dst + i, select(x, f1, f0));
+                }
+                if(Align < 32 && i < n)
+                    ternary_sse2<Align>(dst + i, a + i, b + i, c + i, n - i, table);
+            }
 
-            bool operator==(internal_pointer<true> const& other) const
+            // vpternlogq takes the truth table as an immediate, so there is one instantiation per table
+            template<uint8_t Table, size_t Align>
+            DB_TARGET("avx512f") void ternary_avx512_imm(std::byte* dst, std::byte const* a, std::byte const* b,
+                                                         std::byte const* c, size_t n) noexcept
             {
-                return byte == other.byte && offset == other.offset;
+                size_t i = 0;
+                for(; i + 64 <= n; i += 64)
+                {
+                    const __m512i x = load<Align>(a + i, __m512i());
+                    const __m512i y = load<Align>(b + i, __m512i());
+                    const __m512i z = load<Align>(c + i, __m512i());
+                    store<Align>(dst + i, _mm512_ternarylogic_epi64(x, y, z, Table));
+                }
+                if(Align < 64 && i < n)
+                    ternary_avx2<Align>(dst + i, a + i, b + i, c + i, n - i, Table);
             }
 
-            bool operator!=(internal_pointer<true> const& other) const { return !(*this == other); }
+            template<size_t Align, size_t... Tables>
+            void ternary_avx512_table(std::index_sequence<Tables...>, std::byte* dst, std::byte const* a,
+                                      std::byte const* b, std::byte const* c, size_t n, uint8_t table) noexcept
+            {
+                using kernel = void (*)(std::byte*, std::byte const*, std::byte const*, std::byte const*, size_t) noexcept;
+                static constexpr kernel kernels[] = {&ternary_avx512_imm<uint8_t(Tables), Align>...};
+                kernels[table](dst, a, b, c, n);
+            }
 
-            bool operator<(internal_pointer<true> const& other) const
+            template<size_t Align = 1>
+            void ternary_avx512(std::byte* dst, std::byte const* a, std::byte const* b, std::byte const* c,
+                                size_t n, uint8_t table) noexcept
             {
-                if(byte < other.byte) return true;
-                if(byte > other.byte) return false;
-                return offset < other.offset;
+                ternary_avx512_table<Align>(std::make_index_sequence<256>(), dst, a, b, c, n, table);
             }
+            #endif
 
-            bool operator>(internal_pointer<true> const& other) const { return other < *this; }
-            bool operator<=(internal_pointer<true> const& other) const { return !(*this > other); }
-            bool operator>=(internal_pointer<true> const& other) const { return !(*this < other); }
+            // Offset in n bytes where a byte other than Skip may start : every byte before it is Skip, and
+            // one of the next 64 bytes is not. n when all n bytes are Skip. Skip is 0x00 or 0xFF.
+            using skip_kernel = size_t (*)(std::byte const*, size_t) noexcept;
 
-            difference_type operator-(internal_pointer<true> const& other) const
+            template<uint8_t Skip>
+            size_t skip_scalar(std::byte const* p, size_t n) noexcept
             {
-                return (byte - other.byte) * 8 + (offset - other.offset);
+                constexpr uint64_t skipped = Skip == 0 ? 0 : ~uint64_t(0);
+                size_t i = 0;
+                for(; i + sizeof(uint64_t) <= n; i += sizeof(uint64_t))
+                {
+                    uint64_t word;
+                    std::memcpy(&word, p + i, sizeof(word));
+                    if(word != skipped)
+                        return i;
+                }
+                for(; i < n; ++i)
+                    if(p[i] != std::byte(Skip))
+                        return i;
+                return n;
             }
 
-        private:
-            std::byte* byte;
-            uint8_t offset;
-        };
+            #ifdef DB_SIMD_DISPATCH
+            template<uint8_t Skip>
+            DB_TARGET("sse2") size_t skip_sse2(std::byte const* p, size_t n) noexcept
+            {
+                const __m128i skipped = _mm_set1_epi8(char(Skip));
+                size_t i = 0;
+                for(; i + 16 <= n; i += 16)
+                {
+                    const __m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p + i));
+                    if(_mm_movemask_epi8(_mm_cmpeq_epi8(v, skipped)) != 0xFFFF)
+                        return i;
+                }
+                return i + skip_scalar<Skip>(p + i, n - i);
+            }
 
-    public:
-        using pointer = internal_pointer<false>;
-        using const_pointer = internal_pointer<true>;
-        using iterator = pointer;
-        using const_iterator = const_pointer;
-        using reverse_iterator = std::reverse_iterator<iterator>;
-        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+            // vptest : ZF tells v is all zeros, CF that it is all ones
+            template<uint8_t Skip>
+            DB_TARGET("avx2") size_t skip_avx2(std::byte const* p, size_t n) noexcept
+            {
+                const __m256i ones = _mm256_set1_epi8(char(0xFF));
+                size_t i = 0;
+                for(; i + 32 <= n; i += 32)
+                {
+                    const __m256i v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p + i));
+                    if(Skip == 0 ? !_mm256_testz_si256(v, v) : !_mm256_testc_si256(v, ones))
+                        return i;
+                }
+                return i + skip_sse2<Skip>(p + i, n - i);
+            }
 
-        // Constructors
-        DynamicBitset() noexcept(std::is_nothrow_default_constructible_v<Allocator>);
-        explicit DynamicBitset(Allocator const& alloc) noexcept(std::is_nothrow_copy_constructible_v<Allocator>);
-        explicit DynamicBitset(size_type count, Allocator const& alloc = Allocator());
-        explicit DynamicBitset(size_type count, bool value, Allocator const& alloc = Allocator());
-        template<size_t N>
-        DynamicBitset(bool const (& bools)[N], Allocator const& alloc = Allocator());
-        template<typename Iter, typename = std::enable_if_t<detail::is_input_iterator_v<Iter>>>
-        DynamicBitset(Iter first, Iter last, Allocator const& alloc = Allocator());
-        DynamicBitset(DynamicBitset const& other);
-        DynamicBitset(DynamicBitset const& other, Allocator const& alloc);
-        DynamicBitset(DynamicBitset&& other) noexcept;
-        DynamicBitset(DynamicBitset&& other, Allocator const& alloc) noexcept(std::is_nothrow_copy_constructible_v<Allocator>);
-        DynamicBitset(std::initializer_list<bool> ilist, Allocator const& alloc = Allocator());
+            // vptestmq against zero, vpcmpq against all ones
+            template<uint8_t Skip>
+            DB_TARGET("avx512f") size_t skip_avx512(std::byte const* p, size_t n) noexcept
+            {
+                const __m512i ones = _mm512_set1_epi64(-1);
+                size_t i = 0;
+                for(; i + 64 <= n; i += 64)
+                {
+                    const __m512i v = _mm512_loadu_si512(p + i);
+                    if((Skip == 0 ? _mm512_test_epi64_mask(v, v) : _mm512_cmpneq_epi64_mask(v, ones)) != 0)
+                        return i;
+                }
+                return i + skip_avx2<Skip>(p + i, n - i);
+            }
+            #endif
 
-        ~DynamicBitset();
+            // Backward counterpart : length of the prefix of the n bytes that may hold a non-zero byte.
+            // Every byte after it is zero, and one of its last 64 bytes is not. 0 when all are zero.
+            inline size_t skip_zeros_backward_scalar(std::byte const* p, size_t n) noexcept
+            {
+                size_t i = n;
+                for(; i >= sizeof(uint64_t); i -= sizeof(uint64_t))
+                {
+                    uint64_t word;
+                    std::memcpy(&word, p + i - sizeof(word), sizeof(word));
+                    if(word != 0)
+                        return i;
+                }
+                for(; i > 0; --i)
+                    if(p[i - 1] != std::byte(0))
+                        return i;
+                return 0;
+            }
+
+            #ifdef DB_SIMD_DISPATCH
+            DB_TARGET("sse2") inline size_t skip_zeros_backward_sse2(std::byte const* p, size_t n) noexcept
+            {
+                size_t i = n;
+                for(; i >= 16; i -= 16)
+                {
+                    const __m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p + i - 16));
+                    if(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())) != 0xFFFF)
+                        return i;
+                }
+                return skip_zeros_backward_scalar(p, i);
+            }
+
+            DB_TARGET("avx2") inline size_t skip_zeros_backward_avx2(std::byte const* p, size_t n) noexcept
+            {
+                size_t i = n;
+                for(; i >= 32; i -= 32)
+                {
+                    const __m256i v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p + i - 32));
+                    if(!_mm256_testz_si256(v, v))
+                        return i;
+                }
+                return skip_zeros_backward_sse2(p, i);
+            }
+
+            DB_TARGET("avx512f") inline size_t skip_zeros_backward_avx512(std::byte const* p, size_t n) noexcept
+            {
+                size_t i = n;
+                for(; i >= 64; i -= 64)
+                {
+                    const __m512i v = _mm512_loadu_si512(p + i - 64);
+                    if(_mm512_test_epi64_mask(v, v) != 0)
+                        return i;
+                }
+                return skip_zeros_backward_avx2(p, i);
+            }
+            #endif
+
+            // Number of set bits in n bytes, resp. in Op(a, b) over n bytes, resp. in both Op1(a, b) and
+            // Op2(a, b) from one read of a and b
+            using popcount_kernel = size_t (*)(std::byte const*, size_t) noexcept;
+            using binary_popcount_kernel = size_t (*)(std::byte const*, std::byte const*, size_t) noexcept;
+            using binary_popcount_pair_kernel = std::array<size_t, 2> (*)(std::byte const*, std::byte const*, size_t) noexcept;
+
+            inline size_t popcount_scalar(std::byte const* p, size_t n) noexcept
+            {
+                size_t sum = 0, i = 0;
+                for(; i + sizeof(uint64_t) <= n; i += sizeof(uint64_t))
+                {
+                    uint64_t word;
+                    std::memcpy(&word, p + i, sizeof(word));
+                    sum += detail::popcount(word);
+                }
+                for(; i < n; ++i)
+                    sum += detail::popcount(uint8_t(p[i]));
+                return sum;
+            }
+
+            template<typename Op>
+            size_t binary_popcount_scalar(std::byte const* a, std::byte const* b, size_t n) noexcept
+            {
+                size_t sum = 0, i = 0;
+                for(; i + sizeof(uint64_t) <= n; i += sizeof(uint64_t))
+                {
+                    uint64_t x, y;
+                    std::memcpy(&x, a + i, sizeof(x));
+                    std::memcpy(&y, b + i, sizeof(y));
+                    sum += detail::popcount(Op::scalar(x, y));
+                }
+                for(; i < n; ++i)
+                    sum += detail::popcount(Op::scalar(uint8_t(a[i]), uint8_t(b[i])));
+                return sum;
+            }
+
+            template<typename Op1, typename Op2>
+            std::array<size_t, 2> binary_popcount_pair_scalar(std::byte const* a, std::byte const* b, size_t n) noexcept
+            {
+                std::array<size_t, 2> sums = {};
+                size_t i = 0;
+                for(; i + sizeof(uint64_t) <= n; i += sizeof(uint64_t))
+                {
+                    uint64_t x, y;
+                    std::memcpy(&x, a + i, sizeof(x));
+                    std::memcpy(&y, b + i, sizeof(y));
+                    sums[0] += detail::popcount(Op1::scalar(x, y));
+                    sums[1] += detail::popcount(Op2::scalar(x, y));
+                }
+                for(; i < n; ++i)
+                {
+                    sums[0] += detail::popcount(Op1::scalar(uint8_t(a[i]), uint8_t(b[i])));
+                    sums[1] += detail::popcount(Op2::scalar(uint8_t(a[i]), uint8_t(b[i])));
+                }
+                return sums;
+            }
+
+            #ifdef DB_SIMD_DISPATCH
+            // Same loop, where the builtin becomes the POPCNT instruction
+            DB_TARGET("popcnt") inline size_t popcount_popcnt(std::byte const* p, size_t n) noexcept
+            {
+                size_t sum = 0, i = 0;
+                for(; i + sizeof(uint64_t) <= n; i += sizeof(uint64_t))
+                {
+                    uint64_t word;
+                    std::memcpy(&word, p + i, sizeof(word));
+                    sum += size_t(__builtin_popcountll(word));
+                }
+                for(; i < n; ++i)
+                    sum += size_t(__builtin_popcount(unsigned(p[i])));
+                return sum;
+            }
+
+            template<typename Op>
+            DB_TARGET("popcnt") size_t binary_popcount_popcnt(std::byte const* a, std::byte const* b, size_t n) noexcept
+            {
+                size_t sum = 0, i = 0;
+                for(; i + sizeof(uint64_t) <= n; i += sizeof(uint64_t))
+                {
+                    uint64_t x, y;
+                    std::memcpy(&x, a + i, sizeof(x));
+                    std::memcpy(&y, b + i, sizeof(y));
+                    sum += size_t(__builtin_popcountll(Op::scalar(x, y)));
+                }
+                for(; i < n; ++i)
+                    sum += size_t(__builtin_popcount(unsigned(Op::scalar(uint8_t(a[i]), uint8_t(b[i])))));
+                return sum;
+            }
+
+            template<typename Op1, typename Op2>
+            DB_TARGET("popcnt") std::array<size_t, 2> binary_popcount_pair_popcnt(std::byte const* a, std::byte const* b, size_t n) noexcept
+            {
+                std::array<size_t, 2> sums = {};
+                size_t i = 0;
+                for(; i + sizeof(uint64_t) <= n; i += sizeof(uint64_t))
+                {
+                    uint64_t x, y;
+                    std::memcpy(&x, a + i, sizeof(x));
+                    std::memcpy(&y, b + i, sizeof(y));
+                    sums[0] += size_t(__builtin_popcountll(Op1::scalar(x, y)));
+                    sums[1] += size_t(__builtin_popcountll(Op2::scalar(x, y)));
+                }
+                for(; i < n; ++i)
+                {
+                    sums[0] += size_t(__builtin_popcount(unsigned(Op1::scalar(uint8_t(a[i]), uint8_t(b[i])))));
+                    sums[1] += size_t(__builtin_popcount(unsigned(Op2::scalar(uint8_t(a[i]), uint8_t(b[i])))));
+                }
+                return sums;
+            }
+
+            // Bit counts of the four 64-bit lanes, through a vpshufb lookup of each nibble
+            DB_TARGET("avx2") inline __m256i popcount_lanes(__m256i v) noexcept
+            {
+                const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                                        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+                const __m256i low = _mm256_set1_epi8(0x0F);
+                const __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, _mm256_and_si256(v, low)),
+                                                       _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), low)));
+                return _mm256_sad_epu8(counts, _mm256_setzero_si256());
+            }
+
+            DB_TARGET("avx2") inline size_t sum_lanes(__m256i v) noexcept
+            {
+                alignas(32) uint64_t lanes[4];
+                _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), v);
+                return size_t(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+            }
+
+            // Carry-save adder : high gets the carries and low the sums of a + b + c
+            DB_TARGET("avx2") inline void csa(__m256i& high, __m256i& low, __m256i a, __m256i b, __m256i c) noexcept
+            {
+                const __m256i u = _mm256_xor_si256(a, b);
+                high = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(u, c));
+                low = _mm256_xor_si256(u, c);
+            }
+
+            // Vector i of the input of a Harley-Seal count : the bytes themselves, or Op of two inputs
+            struct vector_source
+            {
+                __m256i const* v;
+                DB_TARGET("avx2") __m256i operator()(size_t i) const noexcept { return _mm256_loadu_si256(v + i); }
+            };
+
+            template<typename Op>
+            struct binary_vector_source
+            {
+                __m256i const* a;
+                __m256i const* b;
+                DB_TARGET("avx2") __m256i operator()(size_t i) const noexcept { return Op::avx2(_mm256_loadu_si256(a + i), _mm256_loadu_si256(b + i)); }
+            };
+
+            // Harley-Seal : a tree of carry-save adders reduces 16 vectors to one vector of 16s,
+            // so the lookup runs once per 16 vectors
+            template<typename Source>
+            DB_TARGET("avx2") size_t harley_seal(Source const& v, size_t vectors) noexcept
+            {
+                __m256i total = _mm256_setzero_si256();
+                __m256i ones = _mm256_setzero_si256(), twos = ones, fours = ones, eights = ones, sixteens;
+                __m256i twos_a, twos_b, fours_a, fours_b, eights_a, eights_b;
+                size_t i = 0;
+                for(; i + 16 <= vectors; i += 16)
+                {
+                    csa(twos_a, ones, ones, v(i), v(i + 1));
+                    csa(twos_b, ones, ones, v(i + 2), v(i + 3));
+                    csa(fours_a, twos, twos, twos_a, twos_b);
+                    csa(twos_a, ones, ones, v(i + 4), v(i + 5));
+                    csa(twos_b, ones, ones, v(i + 6), v(i + 7));
+                    csa(fours_b, twos, twos, twos_a, twos_b);
+                    csa(eights_a, fours, fours, fours_a, fours_b);
+                    csa(twos_a, ones, ones, v(i + 8), v(i + 9));
+                    csa(twos_b, ones, ones, v(i + 10), v(i + 11));
+                    csa(fours_a, twos, twos, twos_a, twos_b);
+                    csa(twos_a, ones, ones, v(i + 12), v(i + 13));
+                    csa(twos_b, ones, ones, v(i + 14), v(i + 15));
+                    csa(fours_b, twos, twos, twos_a, twos_b);
+                    csa(eights_b, fours, fours, fours_a, fours_b);
+                    csa(sixteens, eights, eights, eights_a, eights_b);
+                    total = _mm256_add_epi64(total, popcount_lanes(sixteens));
+                }
+                total = _mm256_slli_epi64(total, 4);
+                total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount_lanes(eights), 3));
+                total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount_lanes(fours), 2));
+                total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount_lanes(twos), 1));
+                total = _mm256_add_epi64(total, popcount_lanes(ones));
+                for(; i < vectors; ++i)
+                    total = _mm256_add_epi64(total, popcount_lanes(v(i)));
+
+                return sum_lanes(total);
+            }
+
+            // Harley-Seal step over 8 vectors, with the fours as the last level of carries. Two such
+            // counters fit in the registers, where two 16-vector trees would not.
+            DB_TARGET("avx2") inline void harley_seal_step(__m256i& total, __m256i& ones, __m256i& twos, __m256i& fours, __m256i const (&v)[8]) noexcept
+            {
+                __m256i twos_a, twos_b, fours_a, fours_b, eights;
+                csa(twos_a, ones, ones, v[0], v[1]);
+                csa(twos_b, ones, ones, v[2], v[3]);
+                csa(fours_a, twos, twos, twos_a, twos_b);
+                csa(twos_a, ones, ones, v[4], v[5]);
+                csa(twos_b, ones, ones, v[6], v[7]);
+                csa(fours_b, twos, twos, twos_a, twos_b);
+                csa(eights, fours, fours, fours_a, fours_b);
+                total = _mm256_add_epi64(total, popcount_lanes(eights));
+            }
+
+            DB_TARGET("avx2") inline size_t harley_seal_finish(__m256i total, __m256i ones, __m256i twos, __m256i fours) noexcept
+            {
+                total = _mm256_slli_epi64(total, 3);
+                total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount_lanes(fours), 2));
+                total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount_lanes(twos), 1));
+                return sum_lanes(_mm256_add_epi64(total, popcount_lanes(ones)));
+            }
+
+            DB_TARGET("avx2") inline size_t popcount_avx2(std::byte const* p, size_t n) noexcept
+            {
+                const size_t vectors = n / 32;
+                return harley_seal(vector_source{reinterpret_cast<__m256i const*>(p)}, vectors) + popcount_popcnt(p + vectors * 32, n - vectors * 32);
+            }
+
+            template<typename Op>
+            DB_TARGET("avx2") size_t binary_popcount_avx2(std::byte const* a, std::byte const* b, size_t n) noexcept
+            {
+                const size_t vectors = n / 32;
+                const binary_vector_source<Op> source{reinterpret_cast<__m256i const*>(a), reinterpret_cast<__m256i const*>(b)};
+                return harley_seal(source, vectors) + binary_popcount_popcnt<Op>(a + vectors * 32, b + vectors * 32, n - vectors * 32);
+            }
+
+            // Each pair of vectors is loaded once and feeds one Harley-Seal counter per operation
+            template<typename Op1, typename Op2>
+            DB_TARGET("avx2") std::array<size_t, 2> binary_popcount_pair_avx2(std::byte const* a, std::byte const* b, size_t n) noexcept
+            {
+                __m256i const* const x = reinterpret_cast<__m256i const*>(a);
+                __m256i const* const y = reinterpret_cast<__m256i const*>(b);
+                __m256i total[2], ones[2], twos[2], fours[2];
+                for(size_t k = 0; k < 2; ++k)
+                    total[k] = ones[k] = twos[k] = fours[k] = _mm256_setzero_si256();
+                size_t i = 0;
+                for(; i + 8 <= n / 32; i += 8)
+                {
+                    __m256i first[8], second[8];
+                    for(size_t k = 0; k < 8; ++k)
+                    {
+                        const __m256i u = _mm256_loadu_si256(x + i + k), v = _mm256_loadu_si256(y + i + k);
+                        first[k] = Op1::avx2(u, v);
+                        second[k] = Op2::avx2(u, v);
+                    }
+                    harley_seal_step(total[0], ones[0], twos[0], fours[0], first);
+                    harley_seal_step(total[1], ones[1], twos[1], fours[1], second);
+                }
+                std::array<size_t, 2> sums = binary_popcount_pair_popcnt<Op1, Op2>(a + i * 32, b + i * 32, n - i * 32);
+                sums[0] += harley_seal_finish(total[0], ones[0], twos[0], fours[0]);
+                sums[1] += harley_seal_finish(total[1], ones[1], twos[1], fours[1]);
+                return sums;
+            }
+
+            DB_TARGET("avx512f,avx512vpopcntdq") inline size_t popcount_avx512(std::byte const* p, size_t n) noexcept
+            {
+                __m512i total = _mm512_setzero_si512();
+                size_t i = 0;
+                for(; i + 64 <= n; i += 64)
+                    total = _mm512_add_epi64(total, _mm512_popcnt_epi64(_mm512_loadu_si512(p + i)));
+                alignas(64) uint64_t lanes[8];
+                _mm512_store_si512(lanes, total);
+                size_t sum = 0;
+                for(uint64_t lane : lanes)
+                    sum += size_t(lane);
+                return sum + popcount_avx2(p + i, n - i);
+            }
+
+            template<typename Op>
+            DB_TARGET("avx512f,avx512vpopcntdq") size_t binary_popcount_avx512(std::byte const* a, std::byte const* b, size_t n) noexcept
+            {
+                __m512i total = _mm512_setzero_si512();
+                size_t i = 0;
+                for(; i + 64 <= n; i += 64)
+                    total = _mm512_add_epi64(total, _mm512_popcnt_epi64(Op::avx512(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i))));
+                alignas(64) uint64_t lanes[8];
+                _mm512_store_si512(lanes, total);
+                size_t sum = 0;
+                for(uint64_t lane : lanes)
+                    sum += size_t(lane);
+                return sum + binary_popcount_avx2<Op>(a + i, b + i, n - i);
+            }
+
+            template<typename Op1, typename Op2>
+            DB_TARGET("avx512f,avx512vpopcntdq") std::array<size_t, 2> binary_popcount_pair_avx512(std::byte const* a, std::byte const* b, size_t n) noexcept
+            {
+                __m512i first = _mm512_setzero_si512(), second = _mm512_setzero_si512();
+                size_t i = 0;
+                for(; i + 64 <= n; i += 64)
+                {
+                    const __m512i u = _mm512_loadu_si512(a + i), v = _mm512_loadu_si512(b + i);
+                    first = _mm512_add_epi64(first, _mm512_popcnt_epi64(Op1::avx512(u, v)));
+                    second = _mm512_add_epi64(second, _mm512_popcnt_epi64(Op2::avx512(u, v)));
+                }
+                alignas(64) uint64_t lanes[2][8];
+                _mm512_store_si512(lanes[0], first);
+                _mm512_store_si512(lanes[1], second);
+                std::array<size_t, 2> sums = binary_popcount_pair_avx2<Op1, Op2>(a + i, b + i, n - i);
+                for(size_t k = 0; k < 8; ++k)
+                {
+                    sums[0] += size_t(lanes[0][k]);
+                    sums[1] += size_t(lanes[1][k]);
+                }
+                return sums;
+            }
+            #endif
+
+            struct popcount_kernels
+            {
+                using kernel = popcount_kernel;
+                static constexpr kernel scalar = &popcount_scalar;
+                #ifdef DB_SIMD_DISPATCH
+                static constexpr kernel popcnt = &popcount_popcnt;
+                static constexpr kernel avx2 = &popcount_avx2;
+                static constexpr kernel avx512 = &popcount_avx512;
+                #endif
+            };
+
+            template<typename Op>
+            struct binary_popcount_kernels
+            {
+                using kernel = binary_popcount_kernel;
+                static constexpr kernel scalar = &binary_popcount_scalar<Op>;
+                #ifdef DB_SIMD_DISPATCH
+                static constexpr kernel popcnt = &binary_popcount_popcnt<Op>;
+                static constexpr kernel avx2 = &binary_popcount_avx2<Op>;
+                static constexpr kernel avx512 = &binary_popcount_avx512<Op>;
+                #endif
+            };
+
+            template<typename Op1, typename Op2>
+            struct binary_popcount_pair_kernels
+            {
+                using kernel = binary_popcount_pair_kernel;
+                static constexpr kernel scalar = &binary_popcount_pair_scalar<Op1, Op2>;
+                #ifdef DB_SIMD_DISPATCH
+                static constexpr kernel popcnt = &binary_popcount_pair_popcnt<Op1, Op2>;
+                static constexpr kernel avx2 = &binary_popcount_pair_avx2<Op1, Op2>;
+                static constexpr kernel avx512 = &binary_popcount_pair_avx512<Op1, Op2>;
+                #endif
+            };
+
+            // Popcount kernels have their own ladder : AVX-512F alone brings no population count,
+            // and SSE2 no POPCNT
+            template<typename Kernels>
+            typename Kernels::kernel select_popcount() noexcept
+            {
+                #ifdef DB_SIMD_DISPATCH
+                __builtin_cpu_init();
+                if(__builtin_cpu_supports("avx512vpopcntdq"))
+                    return Kernels::avx512;
+                if(HAS_AVX2 || __builtin_cpu_supports("avx2"))
+                    return Kernels::avx2;
+                if(__builtin_cpu_supports("popcnt"))
+                    return Kernels::popcnt;
+                #endif
+                return Kernels::scalar;
+            }
+
+            inline size_t popcount(std::byte const* p, size_t n) noexcept
+            {
+                static const popcount_kernel kernel = select_popcount<popcount_kernels>();
+                return kernel(p, n);
+            }
+
+            template<typename Op>
+            size_t binary_popcount(std::byte const* a, std::byte const* b, size_t n) noexcept
+            {
+                static const binary_popcount_kernel kernel = select_popcount<binary_popcount_kernels<Op>>();
+                return kernel(a, b, n);
+            }
+
+            template<typename Op1, typename Op2>
+            std::array<size_t, 2> binary_popcount_pair(std::byte const* a, std::byte const* b, size_t n) noexcept
+            {
+                static const binary_popcount_pair_kernel kernel = select_popcount<binary_popcount_pair_kernels<Op1, Op2>>();
+                return kernel(a, b, n);
+            }
+
+            // Shifts the n bytes at p, read as a little-endian string of 8n bits, by shift < 8n bits : up
+            // moves bit i to i + shift, down to i - shift, bits shifted out are lost and vacated bits are
+            // zero. Each 64-bit word funnels two source words, the same for every Block type.
+            using shift_kernel = void (*)(std::byte*, size_t, size_t) noexcept;
+
+            // The 64 bits from byte k, zero outside of the n bytes. k may be negative.
+            inline uint64_t load_word(std::byte const* p, size_t n, ptrdiff_t k) noexcept
+            {
+                uint64_t word = 0;
+                const ptrdiff_t first = std::max<ptrdiff_t>(k, 0), last = std::min<ptrdiff_t>(k + 8, ptrdiff_t(n));
+                if(first < last)
+                    std::memcpy(reinterpret_cast<std::byte*>(&word) + (first - k), p + first, size_t(last - first));
+                return word;
+            }
+
+            inline void store_word(std::byte* p, size_t n, ptrdiff_t k, uint64_t word) noexcept
+            {
+                const ptrdiff_t first = std::max<ptrdiff_t>(k, 0), last = std::min<ptrdiff_t>(k + 8, ptrdiff_t(n));
+                if(first < last)
+                    std::memcpy(p + first, reinterpret_cast<std::byte const*>(&word) + (first - k), size_t(last - first));
+            }
+
+            // Scalar shift of the bytes below end (up, from the top down) or from begin (down, from
+            // the bottom up), once the vector loop has done the rest. In place, a word only reads
+            // bytes that are not written yet.
+            inline void shift_up_from(std::byte* p, size_t n, size_t shift, size_t end) noexcept
+            {
+                const ptrdiff_t words = ptrdiff_t(shift / 64 * 8);
+                const unsigned offset = unsigned(shift % 64);
+                for(ptrdiff_t k = ptrdiff_t(end) - 8; k > -8; k -= 8)
+                {
+                    if(k + 8 <= words)
+                    {
+                        // Everything below comes from before the first bit
+                        std::memset(p, 0, size_t(k + 8));
+                        return;
+                    }
+                    uint64_t word = load_word(p, n, k - words);
+                    if(offset != 0)
+                        word = (word << offset) | (load_word(p, n, k - words - 8) >> (64 - offset));
+                    store_word(p, n, k, word);
+                }
+            }
+
+            inline void shift_down_from(std::byte* p, size_t n, size_t shift, size_t begin) noexcept
+            {
+                const ptrdiff_t words = ptrdiff_t(shift / 64 * 8);
+                const unsigned offset = unsigned(shift % 64);
+                for(ptrdiff_t k = ptrdiff_t(begin); k < ptrdiff_t(n); k += 8)
+                {
+                    if(k + words >= ptrdiff_t(n))
+                    {
+                        std::memset(p + k, 0, n - size_t(k));
+                        return;
+                    }
+                    uint64_t word = load_word(p, n, k + words);
+                    if(offset != 0)
+                        word = (word >> offset) | (load_word(p, n, k + words + 8) << (64 - offset));
+                    store_word(p, n, k, word);
+                }
+            }
+
+            template<bool Up>
+            void shift_scalar(std::byte* p, size_t n, size_t shift) noexcept
+            {
+                if constexpr(Up)
+                    shift_up_from(p, n, shift, n);
+                else
+                    shift_down_from(p, n, shift, 0);
+            }
+
+            #ifdef DB_SIMD_DISPATCH
+            // Vector shifts by 64 or more give zero, so a whole word shift needs no special case
+            template<bool Up>
+            DB_TARGET("sse2") void shift_sse2(std::byte* p, size_t n, size_t shift) noexcept
+            {
+                const size_t words = shift / 64 * 8;
+                const __m128i offset = _mm_cvtsi32_si128(int(shift % 64)), back = _mm_cvtsi32_si128(int(64 - shift % 64));
+                if constexpr(Up)
+                {
+                    size_t end = n;
+                    for(; end >= 16 + words + 8; end -= 16)
+                    {
+                        const __m128i a = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p + end - 16 - words));
+                        const __m128i b = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p + end - 24 - words));
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(p + end - 16), _mm_or_si128(_mm_sll_epi64(a, offset), _mm_srl_epi64(b, back)));
+                    }
+                    shift_up_from(p, n, shift, end);
+                }
+                else
+                {
+                    size_t begin = 0;
+                    for(; begin + words + 8 + 16 <= n; begin += 16)
+                    {
+                        const __m128i a = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p + begin + words));
+                        const __m128i b = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p + begin + words + 8));
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(p + begin), _mm_or_si128(_mm_srl_epi64(a, offset), _mm_sll_epi64(b, back)));
+                    }
+                    shift_down_from(p, n, shift, begin);
+                }
+            }
+
+            template<bool Up>
+            DB_TARGET("avx2") void shift_avx2(std::byte* p, size_t n, size_t shift) noexcept
+            {
+                const size_t words = shift / 64 * 8;
+                const __m128i offset = _mm_cvtsi32_si128(int(shift % 64)), back = _mm_cvtsi32_si128(int(64 - shift % 64));
+                if constexpr(Up)
+                {
+                    size_t end = n;
+                    for(; end >= 32 + words + 8; end -= 32)
+                    {
+                        const __m256i a = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p + end - 32 - words));
+                        const __m256i b = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p + end - 40 - words));
+                        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p + end - 32), _mm256_or_si256(_mm256_sll_epi64(a, offset), _mm256_srl_epi64(b, back)));
+                    }
+                    shift_up_from(p, n, shift, end);
+                }
+                else
+                {
+                    size_t begin = 0;
+                    for(; begin + words + 8 + 32 <= n; begin += 32)
+                    {
+                        const __m256i a = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p + begin + words));
+                        const __m256i b = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p + begin + words + 8));
+                        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p + begin), _mm256_or_si256(_mm256_srl_epi64(a, offset), _mm256_sll_epi64(b, back)));
+                    }
+                    shift_down_from(p, n, shift, begin);
+                }
+            }
+
+            // The zero-masking forms, since GCC warns about the undefined source of the plain ones
+            template<bool Up>
+            DB_TARGET("avx512f") void shift_avx512(std::byte* p, size_t n, size_t shift) noexcept
+            {
+                const size_t words = shift / 64 * 8;
+                const __m128i offset = _mm_cvtsi32_si128(int(shift % 64)), back = _mm_cvtsi32_si128(int(64 - shift % 64));
+                const __mmask8 all = 0xFF;
+                if constexpr(Up)
+                {
+                    size_t end = n;
+                    for(; end >= 64 + words + 8; end -= 64)
+                    {
+                        const __m512i a = _mm512_loadu_si512(p + end - 64 - words);
+                        const __m512i b = _mm512_loadu_si512(p + end - 72 - words);
+                        _mm512_storeu_si512(p + end - 64, _mm512_or_si512(_mm512_maskz_sll_epi64(all, a, offset), _mm512_maskz_srl_epi64(all, b, back)));
+                    }
+                    shift_up_from(p, n, shift, end);
+                }
+                else
+                {
+                    size_t begin = 0;
+                    for(; begin + words + 8 + 64 <= n; begin += 64)
+                    {
+                        const __m512i a = _mm512_loadu_si512(p + begin + words);
+                        const __m512i b = _mm512_loadu_si512(p + begin + words + 8);
+                        _mm512_storeu_si512(p + begin, _mm512_or_si512(_mm512_maskz_srl_epi64(all, a, offset), _mm512_maskz_sll_epi64(all, b, back)));
+                    }
+                    shift_down_from(p, n, shift, begin);
+                }
+            }
+            #endif
+
+            template<typename Op, size_t Align>
+            struct binary_kernels
+            {
+                using kernel = binary_kernel;
+                static constexpr kernel scalar = &binary_scalar<Op>;
+                #ifdef DB_SIMD_DISPATCH
+                static constexpr kernel sse2 = &binary_sse2<Op, Align>;
+                static constexpr kernel avx2 = &binary_avx2<Op, Align>;
+                static constexpr kernel avx512 = &binary_avx512<Op, Align>;
+                #endif
+            };
+
+            template<size_t Align>
+            struct ternary_kernels
+            {
+                using kernel = ternary_kernel;
+                static constexpr kernel scalar = &ternary_scalar;
+                #ifdef DB_SIMD_DISPATCH
+                static constexpr kernel sse2 = &ternary_sse2<Align>;
+                static constexpr kernel avx2 = &ternary_avx2<Align>;
+                static constexpr kernel avx512 = &ternary_avx512<Align>;
+                #endif
+            };
+
+            template<uint8_t Skip>
+            struct skip_kernels
+            {
+                using kernel = skip_kernel;
+                static constexpr kernel scalar = &skip_scalar<Skip>;
+                #ifdef DB_SIMD_DISPATCH
+                static constexpr kernel sse2 = &skip_sse2<Skip>;
+                static constexpr kernel avx2 = &skip_avx2<Skip>;
+                static constexpr kernel avx512 = &skip_avx512<Skip>;
+                #endif
+            };
+
+            template<bool Up>
+            struct shift_kernels
+            {
+                using kernel = shift_kernel;
+                static constexpr kernel scalar = &shift_scalar<Up>;
+                #ifdef DB_SIMD_DISPATCH
+                static constexpr kernel sse2 = &shift_sse2<Up>;
+                static constexpr kernel avx2 = &shift_avx2<Up>;
+                static constexpr kernel avx512 = &shift_avx512<Up>;
+                #endif
+            };
+
+            struct skip_backward_kernels
+            {
+                using kernel = skip_kernel;
+                static constexpr kernel scalar = &skip_zeros_backward_scalar;
+                #ifdef DB_SIMD_DISPATCH
+                static constexpr kernel sse2 = &skip_zeros_backward_sse2;
+                static constexpr kernel avx2 = &skip_zeros_backward_avx2;
+                static constexpr kernel avx512 = &skip_zeros_backward_avx512;
+                #endif
+            };
+
+            // Widest kernel of the set the build or the running CPU supports
+            template<typename Kernels>
+            typename Kernels::kernel select_kernel() noexcept
+            {
+                #ifdef DB_SIMD_DISPATCH
+                #if HAS_AVX512
+                return Kernels::avx512;
+                #else
+                __builtin_cpu_init();
+                if(__builtin_cpu_supports("avx512f"))
+                    return Kernels::avx512;
+                if(HAS_AVX2 || __builtin_cpu_supports("avx2"))
+                    return Kernels::avx2;
+                if(HAS_SSE2 || __builtin_cpu_supports("sse2"))
+                    return Kernels::sse2;
+                return Kernels::scalar;
+                #endif
+                #else
+                return Kernels::scalar;
+                #endif
+            }
+
+            template<typename Op, size_t Align = 1>
+            void binary(std::byte* dst, std::byte const* src, size_t n) noexcept
+            {
+                static const binary_kernel kernel = select_kernel<binary_kernels<Op, Align>>();
+                kernel(dst, src, n);
+            }
+
+            template<size_t Align = 1>
+            void ternary(std::byte* dst, std::byte const* a, std::byte const* b, std::byte const* c,
+                         size_t n, uint8_t table) noexcept
+            {
+                static const ternary_kernel kernel = select_kernel<ternary_kernels<Align>>();
+                kernel(dst, a, b, c, n, table);
+            }
+
+            template<uint8_t Skip>
+            size_t skip(std::byte const* p, size_t n) noexcept
+            {
+                static const skip_kernel kernel = select_kernel<skip_kernels<Skip>>();
+                return kernel(p, n);
+            }
+
+            inline size_t skip_zeros_backward(std::byte const* p, size_t n) noexcept
+            {
+                static const skip_kernel kernel = select_kernel<skip_backward_kernels>();
+                return kernel(p, n);
+            }
+
+            template<bool Up>
+            void shift(std::byte* p, size_t n, size_t shift) noexcept
+            {
+                static const shift_kernel kernel = select_kernel<shift_kernels<Up>>();
+                kernel(p, n, shift);
+            }
+        };
+
+        template<typename Block>
+        size_t popcount(Block const* first, Block const* last) noexcept
+        {
+            return simd::popcount(reinterpret_cast<std::byte const*>(first), size_t(last - first) * sizeof(Block));
+        }
+
+        // Lazy bitwise expressions, evaluated word by word into the destination. An expression has
+        // the size of its left operand, the other operands are zero-extended or truncated to it.
+        template<typename T>
+        struct is_bit_expression : std::false_type {};
+
+        template<typename T>
+        static constexpr bool is_bit_expression_v = is_bit_expression<std::remove_cv_t<std::remove_reference_t<T>>>::value;
+
+        // How word i of an expression reads the blocks of a bitset : at i, below i (through <<) or above
+        // i (through >>). The destination picks its evaluation order from it.
+        static constexpr unsigned reads_same = 1, reads_below = 2, reads_above = 4;
+
+        // Blocks of a bitset, captured when the expression is built
+        template<typename Block, typename Order>
+        struct bit_leaf
+        {
+            using block_type = Block;
+            using bit_order = Order;
+
+            template<typename Bitset>
+            explicit bit_leaf(Bitset const& b) noexcept : data{b.blocks()}, blocks{b.num_blocks()}, bits{b.size()} {}
+
+            size_t size() const noexcept { return bits; }
+            // Words below min_blocks() may be read without bound checks
+            size_t min_blocks() const noexcept { return blocks; }
+            Block word(size_t i) const noexcept { return i < blocks ? data[i] : Block(0); }
+            Block word_unchecked(size_t i) const noexcept { return data[i]; }
+            Block const* words() const noexcept { return data; }
+            unsigned aliasing(void const* blocks) const noexcept { return data == blocks ? reads_same : 0; }
+
+        private:
+            Block const* data;
+            size_t blocks;
+            size_t bits;
+        };
+
+        template<typename Op, typename L, typename R>
+        struct bit_binary
+        {
+            static_assert(std::is_same_v<typename L::block_type, typename R::block_type> && std::is_same_v<typename L::bit_order, typename R::bit_order>,
+                          "Operands of a bitwise expression must share their block type and bit order");
+
+            using block_type = typename L::block_type;
+            using bit_order = typename L::bit_order;
+
+            bit_binary(L l, R r) noexcept : lhs{l}, rhs{r} {}
+
+            size_t size() const noexcept { return lhs.size(); }
+            size_t min_blocks() const noexcept { return std::min(lhs.min_blocks(), rhs.min_blocks()); }
+            block_type word(size_t i) const noexcept { return Op::scalar(lhs.word(i), rhs.word(i)); }
+            block_type word_unchecked(size_t i) const noexcept { return Op::scalar(lhs.word_unchecked(i), rhs.word_unchecked(i)); }
+            unsigned aliasing(void const* blocks) const noexcept { return lhs.aliasing(blocks) | rhs.aliasing(blocks); }
+
+        private:
+            L lhs;
+            R rhs;
+        };
+
+        template<typename E>
+        struct bit_not
+        {
+            using block_type = typename E::block_type;
+            using bit_order = typename E::bit_order;
+
+            explicit bit_not(E e) noexcept : operand{e} {}
+
+            // The complement of the padding is cut off when the expression is stored
+            size_t size() const noexcept { return operand.size(); }
+            size_t min_blocks() const noexcept { return operand.min_blocks(); }
+            block_type word(size_t i) const noexcept { return block_type(~operand.word(i)); }
+            block_type word_unchecked(size_t i) const noexcept { return block_type(~operand.word_unchecked(i)); }
+            unsigned aliasing(void const* blocks) const noexcept { return operand.aliasing(blocks); }
+
+        private:
+            E operand;
+        };
+
+        // E shifted as by << when Up, else as by >>. Word i funnels two words of E, read as zeros
+        // past its size : the padding of E may not be zero when it holds a complement.
+        template<typename E, bool Up>
+        struct bit_shift
+        {
+            using order = detail::bit_order<typename E::bit_order, typename E::block_type>;
+            using block_type = typename E::block_type;
+            using bit_order = typename E::bit_order;
+
+            bit_shift(E e, size_t n) noexcept
+                : operand{e},
+                  words{std::min(n, e.size()) / order::bits},
+                  offset{std::min(n, e.size()) % order::bits},
+                  blocks{(e.size() + order::bits - 1) / order::bits},
+                  last_mask{e.size() % order::bits == 0 ? block_type(~block_type(0)) : order::head(e.size() % order::bits)}
+            {}
+
+            size_t size() const noexcept { return operand.size(); }
+            // Every word is checked, a shift reads past the word it produces
+            size_t min_blocks() const noexcept { return 0; }
+            block_type word(size_t i) const noexcept
+            {
+                // Out of range indices wrap around and read as zeros
+                const size_t j = Up ? i - words : i + words;
+                if(offset == 0)
+                    return source(j);
+                return Up ? block_type(order::shift_up(source(j), offset) | order::shift_down(source(j - 1), order::bits - offset))
+                          : block_type(order::shift_down(source(j), offset) | order::shift_up(source(j + 1), order::bits - offset));
+            }
+            block_type word_unchecked(size_t i) const noexcept { return word(i); }
+            unsigned aliasing(void const* blocks) const noexcept
+            {
+                const unsigned inner = operand.aliasing(blocks);
+                return inner == 0 || (words == 0 && offset == 0) ? inner : inner | (Up ? reads_below : reads_above);
+            }
+
+        private:
+            block_type source(size_t j) const noexcept
+            {
+                if(j >= blocks)
+                    return block_type(0);
+                return j + 1 == blocks ? block_type(operand.word(j) & last_mask) : operand.word(j);
+            }
+
+            E operand;
+            size_t words;
+            size_t offset;
+            size_t blocks;
+            block_type last_mask;
+        };
+
+        template<typename Block, typename Order>
+        struct is_bit_expression<bit_leaf<Block, Order>> : std::true_type {};
+        template<typename Op, typename L, typename R>
+        struct is_bit_expression<bit_binary<Op, L, R>> : std::true_type {};
+        template<typename E>
+        struct is_bit_expression<bit_not<E>> : std::true_type {};
+        template<typename E, bool Up>
+        struct is_bit_expression<bit_shift<E, Up>> : std::true_type {};
+
+        // Bitsets become leaves, expressions are kept as they are
+        template<typename T, typename = void>
+        struct bit_operand {};
+
+        template<typename T>
+        struct bit_operand<T, std::enable_if_t<is_bit_expression_v<T>>>
+        {
+            using type = T;
+            static T const& make(T const& e) noexcept { return e; }
+        };
+
+        template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+        struct bit_operand<DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>>
+        {
+            using type = bit_leaf<Block, BitOrder>;
+            static type make(DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy> const& b) noexcept { return type(b); }
+        };
+
+        template<typename T, typename = void>
+        static constexpr bool is_bit_operand_v = false;
+
+        template<typename T>
+        static constexpr bool is_bit_operand_v<T, std::void_t<typename bit_operand<T>::type>> = true;
+
+        // Range of the indices of the set bits of a block array, in increasing order. Its iterator keeps
+        // the current block with the visited bits cleared, and moves on to the next non-zero block
+        // only when it is empty : zero bits cost nothing but their share of zero blocks.
+        template<typename Block, typename Order>
+        class ones_view
+        {
+            using order = bit_order<Order, Block>;
+
+        public:
+            class iterator
+            {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = size_t;
+                using difference_type = std::ptrdiff_t;
+                using pointer = void;
+                using reference = size_t;
+
+                iterator() noexcept = default;
+                iterator(Block const* blocks, size_t count, size_t index) noexcept : blocks{blocks}, count{count}, index{index}
+                {
+                    if(index < count)
+                    {
+                        word = blocks[index];
+                        skip_empty();
+                    }
+                }
+
+                size_t operator*() const noexcept { return index * order::bits + order::first(word); }
+
+                iterator& operator++() noexcept
+                {
+                    // Clears the first set bit : blsr for lsb_first
+                    if constexpr(std::is_same_v<Order, lsb_first>)
+                        word = Block(word & (word - 1));
+                    else
+                        word = Block(word & ~order::bit(order::first(word)));
+                    skip_empty();
+                    return *this;
+                }
+
+                iterator operator++(int) noexcept
+                {
+                    iterator it = *this;
+                    ++*this;
+                    return it;
+                }
+
+                bool operator==(iterator const& other) const noexcept { return index == other.index && word == other.word; }
+                bool operator!=(iterator const& other) const noexcept { return !(*this == other); }
+
+            private:
+                void skip_empty() noexcept
+                {
+                    while(word == 0 && ++index < count)
+                        word = blocks[index];
+                }
+
+                Block const* blocks = nullptr;
+                size_t count = 0;
+                size_t index = 0;
+                Block word = 0;
+            };
+            using const_iterator = iterator;
+
+            ones_view(Block const* blocks, size_t count) noexcept : blocks{blocks}, count{count} {}
+
+            iterator begin() const noexcept { return iterator(blocks, count, 0); }
+            iterator end() const noexcept { return iterator(blocks, count, count); }
+            bool empty() const noexcept { return begin() == end(); }
+
+        private:
+            Block const* blocks;
+            size_t count;
+        };
+
+        // Lexicographic comparison of the bit sequences, bit 0 first : negative, zero or positive
+        // as lhs is less than, equal to or greater than rhs
+        template<typename Block, typename Order>
+        int compare(bit_leaf<Block, Order> const& lhs, bit_leaf<Block, Order> const& rhs) noexcept
+        {
+            using order = bit_order<Order, Block>;
+            const size_t common = std::min(lhs.size(), rhs.size());
+            const size_t whole = common / order::bits;
+            const size_t partial = common % order::bits;
+            Block const* const l = lhs.words();
+            Block const* const r = rhs.words();
+
+            // The first differing block, then its first differing bit
+            const auto [first_l, first_r] = std::mismatch(l, l + whole, r);
+            Block diff = 0, word = 0;
+            if(first_l != l + whole)
+            {
+                diff = Block(*first_l ^ *first_r);
+                word = *first_l;
+            }
+            else if(partial != 0)
+            {
+                diff = Block((l[whole] ^ r[whole]) & order::head(partial));
+                word = l[whole];
+            }
+            if(diff != 0)
+                return (word & order::bit(order::first(diff))) != 0 ? 1 : -1;
+            return lhs.size() < rhs.size() ? -1 : lhs.size() > rhs.size() ? 1 : 0;
+        }
+
+        // Popcount of Op(lhs, rhs) for two leaves, without storing the result. Past the shorter leaf,
+        // a bitwise Op mapping two zeros to zero gives either the longer leaf or nothing.
+        template<typename Op, typename L, typename R>
+        size_t popcount_binary_op(L const& lhs, R const& rhs) noexcept
+        {
+            using Block = typename L::block_type;
+            static_assert(Op::scalar(Block(0), Block(0)) == Block(0), "Counted operations must map zero to zero");
+            constexpr bool keeps_lhs = Op::scalar(Block(1), Block(0)) != Block(0);
+            constexpr bool keeps_rhs = Op::scalar(Block(0), Block(1)) != Block(0);
+            const size_t common = std::min(lhs.min_blocks(), rhs.min_blocks());
+            size_t sum = simd::binary_popcount<Op>(reinterpret_cast<std::byte const*>(lhs.words()), reinterpret_cast<std::byte const*>(rhs.words()),
+                                                   common * sizeof(Block));
+            if constexpr(keeps_lhs)
+                sum += popcount(lhs.words() + common, lhs.words() + lhs.min_blocks());
+            if constexpr(keeps_rhs)
+                sum += popcount(rhs.words() + common, rhs.words() + rhs.min_blocks());
+            return sum;
+        }
+
+        // Popcounts of Op1(lhs, rhs) and Op2(lhs, rhs) in one pass over the common blocks, each tail
+        // being counted at most once for both
+        template<typename Op1, typename Op2, typename L, typename R>
+        std::array<size_t, 2> popcount_binary(L const& lhs, R const& rhs) noexcept
+        {
+            using Block = typename L::block_type;
+            static_assert(Op1::scalar(Block(0), Block(0)) == Block(0) && Op2::scalar(Block(0), Block(0)) == Block(0), "Counted operations must map zero to zero");
+            const size_t common = std::min(lhs.min_blocks(), rhs.min_blocks());
+            std::array<size_t, 2> sums = simd::binary_popcount_pair<Op1, Op2>(reinterpret_cast<std::byte const*>(lhs.words()), reinterpret_cast<std::byte const*>(rhs.words()),
+                                                                             common * sizeof(Block));
+            constexpr std::array<bool, 2> keeps_lhs = {Op1::scalar(Block(1), Block(0)) != Block(0), Op2::scalar(Block(1), Block(0)) != Block(0)};
+            constexpr std::array<bool, 2> keeps_rhs = {Op1::scalar(Block(0), Block(1)) != Block(0), Op2::scalar(Block(0), Block(1)) != Block(0)};
+            if constexpr(keeps_lhs[0] || keeps_lhs[1])
+            {
+                const size_t tail = popcount(lhs.words() + common, lhs.words() + lhs.min_blocks());
+                sums[0] += keeps_lhs[0] ? tail : 0;
+                sums[1] += keeps_lhs[1] ? tail : 0;
+            }
+            if constexpr(keeps_rhs[0] || keeps_rhs[1])
+            {
+                const size_t tail = popcount(rhs.words() + common, rhs.words() + rhs.min_blocks());
+                sums[0] += keeps_rhs[0] ? tail : 0;
+                sums[1] += keeps_rhs[1] ? tail : 0;
+            }
+            return sums;
+        }
+    };
+
+
+    template<typename Allocator = std::allocator<std::byte>, typename Block = uint64_t, size_t Alignment = alignof(Block), typename BitOrder = lsb_first, bool CopyOnWrite = false, typename GrowthPolicy = geometric_growth<>>
+    class DynamicBitset : private Allocator
+    {
+        static_assert(std::is_unsigned_v<Block> && !std::is_same_v<Block, bool>, "Block must be an unsigned integer type");
+        static_assert(Alignment >= alignof(Block) && (Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two no smaller than alignof(Block)");
+
+        template<bool is_const>
+        struct internal_pointer;
+    public:
+        using value_type = bool;
+        using allocator_type = Allocator;
+        using block_type = Block;
+        using bit_order = BitOrder;
+        using size_type = uintptr_t;
+        using difference_type = std::ptrdiff_t;
+
+        static constexpr size_type bits_per_block = sizeof(Block) * CHAR_BIT;
+        // Returned by the searches that find nothing
+        static constexpr size_type npos = std::numeric_limits<size_type>::max();
+        static constexpr size_type alignment = Alignment;
+        static constexpr bool copy_on_write = CopyOnWrite;
+        using growth_policy = GrowthPolicy;
+
+        struct reference
+        {
+            reference(Block* ptr, uint8_t off) noexcept;
+
+            reference& operator=(bool) noexcept;
+
+            reference& operator=(reference const&) noexcept;
+
+            void flip() noexcept;
+
+            internal_pointer<false> operator&();
+
+            operator bool() const noexcept;
+
+            bool operator==(reference const& other) const { return bool(*this) == bool(other); }
+
+            bool operator<(reference const& other) const { return !bool(*this) && bool(other); }
+
+            friend void swap(reference a, reference b)
+            {
+                bool temp = a;
+                a = b;
+                b = temp;
+            }
+
+        private:
+            Block* const block;
+            uint8_t const offset;
+        };
+
+        using const_reference = bool;
+
+    private:
+        template<bool is_const>
+        struct internal_pointer
+        {
+            friend DynamicBitset;
+
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = bool;
+            using reference = std::conditional_t<is_const, typename DynamicBitset::reference const, typename DynamicBitset::reference>;
+            using const_reference = bool;
+            using pointer = internal_pointer;
+            using const_pointer = typename DynamicBitset::template internal_pointer<true>;
+            using difference_type = typename DynamicBitset::difference_type;
+            using size_type = typename DynamicBitset::size_type;
+
+            internal_pointer() = default;
+
+            internal_pointer(Block* ptr, uint8_t off) noexcept;
+
+            internal_pointer(internal_pointer<false> const& other);
+
+            internal_pointer& operator++()
+            {
+                if(offset == bits_per_block - 1)
+                {
+                    ++block;
+                    offset = 0;
+                }
+                else ++offset;
+                return *this;
+            }
+
+            internal_pointer operator++(int)
+            {
+                auto temp = *this;
+                ++*this;
+                return temp;
+            }
+
+            internal_pointer& operator--()
+            {
+                if(offset == 0)
+                {
+                    --block;
+                    offset = bits_per_block - 1;
+                }
+                else --offset;
+                return *this;
+            }
+
+            internal_pointer operator--(int)
+            {
+                auto temp = *this;
+                --*this;
+                return temp;
+            }
+
+            internal_pointer& operator+=(difference_type d);
+
+            internal_pointer& operator-=(difference_type d);
+
+            internal_pointer operator+(difference_type d) const;
+
+            internal_pointer operator-(difference_type d) const;
+
+            reference operator*() { return reference(block, offset); }
+
+            const_reference operator*() const { return static_cast<bool>(reference(block, offset)); }
+
+            reference operator[](difference_type d) const { return *(*this + d); }
+
+            //const_reference operator[](difference_type d) const { return *(*this + d); }
+
+            bool operator==(internal_pointer<true> const& other) const
+            {
+                return block == other.block && offset == other.offset;
+            }
+
+            bool operator!=(internal_pointer<true> const& other) const { return !(*this == other); }
+
+            bool operator<(internal_pointer<true> const& other) const
+            {
+                if(block < other.block) return true;
+                if(block > other.block) return false;
+                return offset < other.offset;
+            }
+
+            bool operator>(internal_pointer<true> const& other) const { return other < *this; }
+            bool operator<=(internal_pointer<true> const& other) const { return !(*this > other); }
+            bool operator>=(internal_pointer<true> const& other) const { return !(*this < other); }
+
+            difference_type operator-(internal_pointer<true> const& other) const
+            {
+                return (block - other.block) * difference_type(bits_per_block) + (difference_type(offset) - difference_type(other.offset));
+            }
+
+        private:
+            Block* block;
+            uint8_t offset;
+        };
+
+    public:
+        using pointer = internal_pointer<false>;
+        using const_pointer = internal_pointer<true>;
+        using iterator = pointer;
+        using const_iterator = const_pointer;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        // Constructors
+        DynamicBitset() noexcept(std::is_nothrow_default_constructible_v<Allocator>);
+        explicit DynamicBitset(Allocator const& alloc) noexcept(std::is_nothrow_copy_constructible_v<Allocator>);
+        explicit DynamicBitset(size_type count, Allocator const& alloc = Allocator());
+        explicit DynamicBitset(size_type count, bool value, Allocator const& alloc = Allocator());
+        template<size_t N>
+        DynamicBitset(bool const (& bools)[N], Allocator const& alloc = Allocator());
+        template<typename Iter, typename = std::enable_if_t<detail::is_input_iterator_v<Iter>>>
+        DynamicBitset(Iter first, Iter last, Allocator const& alloc = Allocator());
+        DynamicBitset(DynamicBitset const& other);
+        DynamicBitset(DynamicBitset const& other, Allocator const& alloc);
+        DynamicBitset(DynamicBitset&& other) noexcept;
+        DynamicBitset(DynamicBitset&& other, Allocator const& alloc) noexcept(std::allocator_traits<Allocator>::is_always_equal::value);
+        DynamicBitset(std::initializer_list<bool> ilist, Allocator const& alloc = Allocator());
+        template<typename Expr, typename = std::enable_if_t<detail::is_bit_expression_v<Expr>>>
+        DynamicBitset(Expr const& expr, Allocator const& alloc = Allocator());
+
+        ~DynamicBitset();
 
         // Copy and assignment
         DynamicBitset& operator=(DynamicBitset const& other);
-        DynamicBitset& operator=(DynamicBitset&& other) noexcept;
+        DynamicBitset& operator=(DynamicBitset&& other) noexcept(std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value
+                                                                 || std::allocator_traits<Allocator>::is_always_equal::value);
         DynamicBitset& operator=(std::initializer_list<bool> ilist);
+        template<typename Expr, typename = std::enable_if_t<detail::is_bit_expression_v<Expr>>>
+        DynamicBitset& operator=(Expr const& expr);
+
+        void assign(size_type count, bool value);
+        template<typename Iter, typename = std::enable_if_t<detail::is_input_iterator_v<Iter>>>
+        void assign(Iter first, Iter last);
+        void assign(std::initializer_list<bool> ilist);
+
+        // Element access
+        reference at(size_type pos);
+        const_reference at(size_type pos) const;
+
+        reference front();
+        const_reference front() const;
+
+        reference back();
+        const_reference back() const;
+
+        // Iterators
+        iterator begin() noexcept(!CopyOnWrite);
+        const_iterator begin() const noexcept;
+        const_iterator cbegin() const noexcept;
+
+        iterator end() noexcept(!CopyOnWrite);
+        const_iterator end() const noexcept;
+        const_iterator cend() const noexcept;
+
+        reverse_iterator rbegin() noexcept(!CopyOnWrite);
+        const_reverse_iterator rbegin() const noexcept;
+        const_reverse_iterator crbegin() const noexcept;
+
+        reverse_iterator rend() noexcept(!CopyOnWrite);
+        const_reverse_iterator rend() const noexcept;
+        const_reverse_iterator crend() const noexcept;
+
+        // Capacity
+        bool empty() const noexcept;
+
+        size_type size() const noexcept;
+        size_type max_size() const noexcept;
+
+        void reserve(size_type new_cap);
+
+        void shrink_to_fit() noexcept;
+
+        size_type capacity() const noexcept;
+
+        // Modifiers
+        void clear() noexcept;
+
+        iterator insert(const_iterator pos, bool value);
+        iterator insert(const_iterator pos, size_type count, bool value);
+        template<typename Iter, typename = std::enable_if_t<detail::is_input_iterator_v<Iter>>>
+        iterator insert(const_iterator pos, Iter first, Iter last);
+        iterator insert(const_iterator pos, std::initializer_list<bool> ilist);
+
+        template<class... Args>
+        iterator emplace(const_iterator pos, Args&& ... args);
+
+        iterator erase(const_iterator pos);
+        iterator erase(const_iterator first, const_iterator last);
+
+        void push_back(bool value);
+
+        void pop_back();
+
+        template<class... Args>
+        reference emplace_back(Args&& ... args);
+
+        void resize(size_type count);
+        void resize(size_type count, value_type value);
+
+        void swap(DynamicBitset& other) noexcept;
+
+        void flip();
+        void flip(size_type n);
+        void flip(const_iterator it);
+
+        // rotate_left moves bit i to (i + n) % size(), as std::rotl does for integers
+        void rotate_left(size_type n);
+        void rotate_right(size_type n);
+        // As std::rotate : middle becomes the first bit of the range, returns the new position of first
+        iterator rotate(const_iterator first, const_iterator middle, const_iterator last);
+
+        static void swap(reference x, reference y);
+
+        // Operators
+        // Bitwise assignments see b zero-extended or truncated to size()
+        DynamicBitset& operator&=(DynamicBitset const& b);
+        DynamicBitset& operator|=(DynamicBitset const& b);
+        DynamicBitset& operator^=(DynamicBitset const& b);
+        template<typename Expr, typename = std::enable_if_t<detail::is_bit_expression_v<Expr>>>
+        DynamicBitset& operator&=(Expr const& expr);
+        template<typename Expr, typename = std::enable_if_t<detail::is_bit_expression_v<Expr>>>
+        DynamicBitset& operator|=(Expr const& expr);
+        template<typename Expr, typename = std::enable_if_t<detail::is_bit_expression_v<Expr>>>
+        DynamicBitset& operator^=(Expr const& expr);
+        // Set difference, bits past b.size() are kept
+        DynamicBitset& operator-=(DynamicBitset const& b);
+        template<typename Expr, typename = std::enable_if_t<detail::is_bit_expression_v<Expr>>>
+        DynamicBitset& operator-=(Expr const& expr);
+        DynamicBitset& and_not(DynamicBitset const& b);
+        DynamicBitset& nand(DynamicBitset const& b);
+        DynamicBitset& nor(DynamicBitset const& b);
+        DynamicBitset& xnor(DynamicBitset const& b);
+        // As for std::bitset, << moves bit i to i + n and >> moves it to i - n. The size is kept,
+        // bits shifted out are lost and the vacated bits are zero. << and >> are lazy expressions.
+        DynamicBitset& operator<<=(size_type n);
+        DynamicBitset& operator>>=(size_type n);
+
+        reference operator[](size_type pos);
+        bool operator[](size_type pos) const;
+
+        // Member functions
+        allocator_type get_allocator() const;
+
+        bool any() const;
+
+        bool none() const;
+
+        // Index of the first set bit, resp. of the first one after pos, or npos
+        size_type find_first() const noexcept;
+
+        size_type find_next(size_type pos) const noexcept;
+        size_type find_next(const_iterator it) const noexcept;
+
+        // Index of the last set bit, resp. of the last one before pos, or npos
+        size_type find_last() const noexcept;
+
+        size_type find_prev(size_type pos) const noexcept;
+        size_type find_prev(const_iterator it) const noexcept;
+
+        // Index of the first zero bit, resp. of the first one after pos, or npos
+        size_type find_first_zero() const noexcept;
+
+        size_type find_next_zero(size_type pos) const noexcept;
+        size_type find_next_zero(const_iterator it) const noexcept;
+
+        // Index of the first run of k zero, resp. one, bits starting at or after from, or npos
+        size_type find_zero_run(size_type k, size_type from = 0) const noexcept;
+        size_type find_one_run(size_type k, size_type from = 0) const noexcept;
+
+        size_type popcount() const;
+        size_type popcount(const_iterator pos, size_type n) const;
+        size_type popcount(const_iterator first, const_iterator last) const;
+
+        // Indices of the set bits, in increasing order. Invalidated as iterators are.
+        using ones_view = detail::ones_view<Block, BitOrder>;
+        ones_view ones() const noexcept;
+
+        // Block access
+        size_type num_blocks() const noexcept;
+        Block block(size_type i) const noexcept;
+
+    private:
+        // Copy-on-write heap buffers start with their reference count, stored in whole vectors
+        using refcount_type = std::atomic<size_type>;
+        static constexpr size_t storage_alignment = CopyOnWrite ? std::max(Alignment, alignof(refcount_type)) : Alignment;
+
+        // Heap blocks are allocated by whole vectors of `alignment` bytes, aligned on `alignment`
+        using vector_type = std::conditional_t<(storage_alignment > sizeof(Block)), detail::aligned_vector<Block, storage_alignment>, Block>;
+        using vector_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<vector_type>;
+        using vector_traits = std::allocator_traits<vector_allocator>;
+        static constexpr size_type blocks_per_vector = sizeof(vector_type) / sizeof(Block);
+
+        static size_type round_to_vector(size_type n) noexcept { return ceil_div<blocks_per_vector>(n) * blocks_per_vector; }
+        // Heap blocks start on a vector and padded_blocks() is whole vectors : between heap operands,
+        // the word kernels run over the padded blocks with aligned loads and no tail
+        static constexpr size_t kernel_alignment = sizeof(vector_type) >= 16 ? std::min<size_t>(sizeof(vector_type), 64) : 1;
+        static constexpr size_type header_blocks = CopyOnWrite ? ceil_div<blocks_per_vector>(ceil_div<sizeof(Block)>(sizeof(refcount_type))) * blocks_per_vector : 0;
+
+        using order = detail::bit_order<BitOrder, Block>;
+
+        static constexpr Block all_ones = Block(~Block(0));
+        static constexpr Block bit_mask(size_type offset) noexcept { return order::bit(offset); }
+        static constexpr Block head_mask(size_type n) noexcept { return order::head(n); }
+        static constexpr Block range_mask(size_type first, size_type last) noexcept { return Block(head_mask(last) & ~head_mask(first)); }
+
+        static Block load_bits(Block const* blocks, size_type pos, size_type n) noexcept;
+        static void store_bits(Block* blocks, size_type pos, Block value, size_type n) noexcept;
+        static void move_bits(Block* blocks, size_type dst, size_type src, size_type n) noexcept;
+        static void swap_bits(Block* blocks, size_type a, size_type b, size_type n) noexcept;
+        void rotate_blocks(size_type n) noexcept;
+        // First bit of Value at or after pos, resp. last set bit before pos
+        template<bool Value>
+        size_type find_from(size_type pos) const noexcept;
+        size_type find_before(size_type pos) const noexcept;
+        template<bool Value>
+        size_type find_run(size_type k, size_type from) const noexcept;
+
+        Block* allocate_blocks(size_type n, bool zeroed = false);
+        bool expand_blocks(size_type n);
+        void deallocate_blocks(Block* p, size_type n) noexcept;
+
+        // Small bitsets keep their blocks inside the object, in place of the heap pointers.
+        // Iterators into inline blocks are therefore invalidated by moves and swaps.
+        static constexpr size_type inline_blocks = 2 * sizeof(Block*) / sizeof(Block);
+        static constexpr size_type heap_flag = size_type(1) << (std::numeric_limits<size_type>::digits - 1);
+
+        bool is_inline() const noexcept { return (d.size & heap_flag) == 0; }
+        Block* blocks() noexcept { return is_inline() ? d.storage.local : d.storage.heap.start; }
+        Block const* blocks() const noexcept { return is_inline() ? d.storage.local : d.storage.heap.start; }
+        size_type block_capacity() const noexcept { return is_inline() ? inline_blocks : d.storage.heap.capacity - d.storage.heap.start; }
+        void set_size(size_type size) noexcept { d.size = (d.size & heap_flag) | size; }
+
+        // Padding invariant : every bit past size(), up to the end of the last block in use (of the
+        // last vector for heap storage), is zero. Block kernels rely on it to work on whole blocks.
+        size_type padded_blocks() const noexcept { return is_inline() ? num_blocks() : round_to_vector(num_blocks()); }
+        void clear_padding() noexcept;
+        void resize_padded(size_type size) noexcept;
+        void fill_blocks(bool value) noexcept;
+        // Runs a word kernel over the blocks shared with b, then Op against zero over the blocks b lacks
+        template<typename Op>
+        DynamicBitset& apply_binary(DynamicBitset const& b);
+        // Stores expr, which may read the current blocks. Each word is read before being written, and
+        // the words go from the top down when expr reads lower words of ours, as a << does.
+        template<typename Expr>
+        void assign_expression(Expr const& expr);
+
+        // Stores f(a, b, c) bit by bit, sized as a, b and c may be any of *this
+        void assign_ternary(DynamicBitset const& a, DynamicBitset const& b, DynamicBitset const& c, uint8_t table);
+
+        template<typename, typename>
+        friend struct detail::bit_leaf;
+        friend void apply3<>(DynamicBitset&, DynamicBitset const&, DynamicBitset const&, DynamicBitset const&, uint8_t);
+        // Discards the contents for count bits of value. Storage too small or shared is replaced
+        // instead of copied, and zero bits come from allocate_zeroed when the allocator has it.
+        void init_blocks(size_type count, bool value);
+        // Takes the contents of other, sharing its buffer when copy-on-write and the allocators allow it
+        void copy_from(DynamicBitset const& other);
+
+        // Copies share the heap buffer of a copy-on-write bitset. Every non-const member that may
+        // write blocks or hand out references detaches first, const members never clone.
+        // References and iterators obtained before a copy still write to the shared buffer.
+        refcount_type& refcount() const noexcept { return *std::launder(reinterpret_cast<refcount_type*>(d.storage.heap.start - header_blocks)); }
+        bool is_shared() const noexcept;
+        void share(DynamicBitset const& other) noexcept;
+        void detach();
+
+        void release_blocks(Block* p, size_type n) noexcept;
+        void destroy() noexcept;
+        void grow(size_type size);
+        void check_length(size_type size) const;
+        allocator_type* alloc() noexcept { return reinterpret_cast<allocator_type*>(this); }
+        allocator_type const* alloc() const noexcept { return reinterpret_cast<allocator_type const*>(this); }
+
+    private:
+        struct data
+        {
+            union
+            {
+                struct
+                {
+                    Block* start;
+                    Block* capacity;
+                } heap;
+                Block local[inline_blocks] = {};
+            } storage;
+            // The most significant bit is set when the blocks live in storage.heap
+            uintptr_t size = 0;
+        };
+        data d;
+    };
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::size_type
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::popcount(const_iterator pos, size_type n) const
+    {
+        if(n == 0)
+            return 0;
+
+        size_type sum = 0;
+        Block const* block = pos.block;
+        size_type last = pos.offset + n;
+
+        if(last <= bits_per_block)
+            return detail::popcount(Block(*block & range_mask(pos.offset, last)));
+
+        sum += detail::popcount(Block(*block++ & range_mask(pos.offset, bits_per_block)));
+        last -= bits_per_block;
+        sum += detail::popcount(block, block + last / bits_per_block);
+        block += last / bits_per_block;
+        last %= bits_per_block;
+        if(last != 0)
+            sum += detail::popcount(Block(*block & head_mask(last)));
+        return sum;
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::size_type
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::popcount(const_iterator first, const_iterator last) const
+    {
+        return popcount(first, last - first);
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::DynamicBitset() noexcept(std::is_nothrow_default_constructible_v<Allocator>) {}
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::DynamicBitset(
+        const Allocator& alloc) noexcept(std::is_nothrow_copy_constructible_v<Allocator>) :
+        Allocator{alloc} {}
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::DynamicBitset(DynamicBitset::size_type count, const Allocator& alloc) :
+        Allocator{alloc}
+    {
+        init_blocks(count, false);
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::reserve(DynamicBitset::size_type new_cap)
+    {
+        if(new_cap > capacity())
+        {
+            check_length(new_cap);
+            size_t num_block = round_to_vector(ceil_div<bits_per_block>(new_cap));
+            if(expand_blocks(num_block))
+                return;
+            Block* temp = allocate_blocks(num_block);
+            std::copy_n(blocks(), num_blocks(), temp);
+            destroy();
+            d.storage.heap.start = temp;
+            d.storage.heap.capacity = temp + num_block;
+            d.size |= heap_flag;
+            clear_padding();
+        }
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    Block* DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::allocate_blocks(size_type n, bool zeroed)
+    {
+        vector_allocator a(*alloc());
+        const size_type count = (header_blocks + n) / blocks_per_vector;
+        Block* p;
+        if constexpr(detail::has_allocate_zeroed<vector_allocator>::value)
+            p = reinterpret_cast<Block*>(std::addressof(*(zeroed ? a.allocate_zeroed(count) : vector_traits::allocate(a, count))));
+        else
+        {
+            p = reinterpret_cast<Block*>(std::addressof(*vector_traits::allocate(a, count)));
+            if(zeroed)
+                std::fill_n(p + header_blocks, n, Block(0));
+        }
+        if constexpr(CopyOnWrite)
+            ::new(static_cast<void*>(p)) refcount_type(1);
+        return p + header_blocks;
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    bool DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::expand_blocks(size_type n)
+    {
+        if constexpr(detail::has_try_reallocate<vector_allocator>::value)
+        {
+            // A shared buffer must be copied anyway
+            if(is_inline() || is_shared())
+                return false;
+
+            vector_allocator a(*alloc());
+            Block* const base = d.storage.heap.start - header_blocks;
+            auto p = a.try_reallocate(std::pointer_traits<typename vector_traits::pointer>::pointer_to(*reinterpret_cast<vector_type*>(base)),
+                                      (header_blocks + block_capacity()) / blocks_per_vector, (header_blocks + n) / blocks_per_vector);
+            if(p == nullptr)
+                return false;
+
+            d.storage.heap.start = reinterpret_cast<Block*>(std::addressof(*p)) + header_blocks;
+            d.storage.heap.capacity = d.storage.heap.start + n;
+            return true;
+        }
+        else
+            return false;
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::deallocate_blocks(Block* p, size_type n) noexcept
+    {
+        p -= header_blocks;
+        if constexpr(CopyOnWrite)
+            std::launder(reinterpret_cast<refcount_type*>(p))->~refcount_type();
+        vector_allocator a(*alloc());
+        vector_traits::deallocate(a, std::pointer_traits<typename vector_traits::pointer>::pointer_to(*reinterpret_cast<vector_type*>(p)), (header_blocks + n) / blocks_per_vector);
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    bool DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::is_shared() const noexcept
+    {
+        if constexpr(CopyOnWrite)
+            return !is_inline() && refcount().load(std::memory_order_acquire) != 1;
+        else
+            return false;
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::share(DynamicBitset const& other) noexcept
+    {
+        // Incrementing first makes sharing with a bitset that already shares our buffer safe
+        other.refcount().fetch_add(1, std::memory_order_relaxed);
+        destroy();
+        d = other.d;
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::detach()
+    {
+        if(!is_shared())
+            return;
+
+        const size_type num_block = block_capacity();
+        Block* temp = allocate_blocks(num_block);
+        std::copy_n(d.storage.heap.start, num_blocks(), temp);
+        destroy();
+        d.storage.heap.start = temp;
+        d.storage.heap.capacity = temp + num_block;
+        clear_padding();
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::release_blocks(Block* p, size_type n) noexcept
+    {
+        if constexpr(CopyOnWrite)
+        {
+            if(std::launder(reinterpret_cast<refcount_type*>(p - header_blocks))->fetch_sub(1, std::memory_order_acq_rel) != 1)
+                return;
+        }
+        deallocate_blocks(p, n);
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::destroy() noexcept
+    {
+        if(!is_inline())
+            release_blocks(d.storage.heap.start, d.storage.heap.capacity - d.storage.heap.start);
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::check_length(size_type size) const
+    {
+        if(size > max_size())
+            throw std::length_error("DynamicBitset size would exceed max_size()");
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::size_type DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::popcount() const
+    {
+        // No need to mask the last block, the padding is zero
+        return detail::popcount(blocks(), blocks() + num_blocks());
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::clear_padding() noexcept
+    {
+        Block* const first = blocks();
+        const size_type used = num_blocks();
+        if(size() % bits_per_block != 0)
+            first[used - 1] &= head_mask(size() % bits_per_block);
+        std::fill(first + used, first + padded_blocks(), Block(0));
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::resize_padded(size_type size) noexcept
+    {
+        // Bits between the old size and the old padded end are already zero, only the blocks
+        // entering the padded range need clearing when growing
+        const size_type old_padded = padded_blocks();
+        set_size(size);
+        if(padded_blocks() > old_padded)
+            std::fill(blocks() + old_padded, blocks() + padded_blocks(), Block(0));
+        else
+            clear_padding();
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::fill_blocks(bool value) noexcept
+    {
+        std::fill_n(blocks(), padded_blocks(), value ? all_ones : Block(0));
+        if(value)
+            clear_padding();
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::copy_from(DynamicBitset const& other)
+    {
+        if constexpr(CopyOnWrite)
+        {
+            if(!other.is_inline() && get_allocator() == other.get_allocator())
+            {
+                share(other);
+                return;
+            }
+            // A shared buffer is about to be overwritten, let the other owners keep it
+            if(is_shared())
+            {
+                destroy();
+                d = data{};
+            }
+        }
+        reserve(other.size());
+        set_size(other.size());
+        std::copy_n(other.blocks(), num_blocks(), blocks());
+        clear_padding();
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::init_blocks(size_type count, bool value)
+    {
+        check_length(count);
+        if(count > capacity() || is_shared())
+        {
+            const size_type num_block = round_to_vector(ceil_div<bits_per_block>(count));
+            Block* temp = allocate_blocks(num_block, !value);
+            destroy();
+            d.storage.heap.start = temp;
+            d.storage.heap.capacity = temp + num_block;
+            d.size = count | heap_flag;
+            if(value)
+                fill_blocks(true);
+        }
+        else
+        {
+            set_size(count);
+            fill_blocks(value);
+        }
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::const_iterator DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::cbegin() const noexcept
+    {
+        return const_iterator(const_cast<Block*>(blocks()), 0);
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    template<size_t N>
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::DynamicBitset(bool const (& bools)[N], Allocator const& alloc) :
+        Allocator{alloc}
+    {
+        reserve(N);
+        resize_padded(N);
+        auto it = begin();
+        for(bool b : bools)
+            *it++ = b;
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::iterator DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::begin() noexcept(!CopyOnWrite)
+    {
+        detach();
+        return iterator(blocks(), 0);
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::const_iterator DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::begin() const noexcept
+    {
+        return cbegin();
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::DynamicBitset(DynamicBitset::size_type count, bool value, const Allocator& alloc) :
+        Allocator(alloc)
+    {
+        init_blocks(count, value);
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    template<typename Iter, typename>
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::DynamicBitset(Iter first, Iter last, Allocator const& alloc) :
+        Allocator(alloc)
+    {
+        auto size = std::distance(first, last);
+        reserve(size);
+        resize_padded(size);
+        std::copy(first, last, begin());
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::DynamicBitset(DynamicBitset const& other) :
+        Allocator(std::allocator_traits<Allocator>::select_on_container_copy_construction(other.get_allocator()))
+    {
+        copy_from(other);
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::DynamicBitset(DynamicBitset const& other, const Allocator& alloc):
+        Allocator(alloc)
+    {
+        copy_from(other);
+    }
 
-        void assign(size_type count, bool value);
-        template<typename Iter, typename = std::enable_if_t<detail::is_input_iterator_v<Iter>>>
-        void assign(Iter first, Iter last);
-        void assign(std::initializer_list<bool> ilist);
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::DynamicBitset(DynamicBitset&& other) noexcept :
+        Allocator(std::move(other))
+    {
+        d = std::exchange(other.d, data{});
+    }
 
-        // Element access
-        reference at(size_type pos);
-        const_reference at(size_type pos) const;
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::DynamicBitset(DynamicBitset&& other,
+                                                   const Allocator& alloc) noexcept(std::allocator_traits<Allocator>::is_always_equal::value)
+        :
+        Allocator(alloc)
+    {
+        // Blocks from another allocator can not be adopted, they are copied instead
+        if(std::allocator_traits<Allocator>::is_always_equal::value || get_allocator() == other.get_allocator())
+            d = std::exchange(other.d, data{});
+        else
+            copy_from(other);
+    }
 
-        reference front();
-        const_reference front() const;
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::DynamicBitset(std::initializer_list<bool> ilist, const Allocator& alloc) :
+        DynamicBitset(ilist.begin(), ilist.end(), alloc) {}
 
-        reference back();
-        const_reference back() const;
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    template<typename Expr, typename>
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::DynamicBitset(Expr const& expr, const Allocator& alloc) :
+        Allocator(alloc)
+    {
+        assign_expression(expr);
+    }
 
-        // Iterators
-        iterator begin() noexcept;
-        const_iterator begin() const noexcept;
-        const_iterator cbegin() const noexcept;
-        
-        iterator end() noexcept;
-        const_iterator end() const noexcept;
-        const_iterator cend() const noexcept;
-        
-        reverse_iterator rbegin() noexcept;
-        const_reverse_iterator rbegin() const noexcept;
-        const_reverse_iterator crbegin() const noexcept;
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::~DynamicBitset()
+    {
+        destroy();
+    }
 
-        reverse_iterator rend() noexcept;
-        const_reverse_iterator rend() const noexcept;
-        const_reverse_iterator crend() const noexcept;
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>& DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::operator=(DynamicBitset const& other)
+    {
+        if constexpr(std::allocator_traits<Allocator>::propagate_on_container_copy_assignment::value)
+        {
+            if(get_allocator() != other.get_allocator())
+            {
+                destroy();
+                d = data{};
+            }
+            *alloc() = *other.alloc();
+        }
+        copy_from(other);
 
-        // Capacity
-        bool empty() const noexcept;
+        return *this;
+    }
 
-        size_type size() const noexcept;
-        size_type max_size() const noexcept;
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>& DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::operator=(DynamicBitset&& other) noexcept(std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value
+                                                                                                                                      || std::allocator_traits<Allocator>::is_always_equal::value)
+    {
+        if(this == &other)
+            return *this;
 
-        void reserve(size_type new_cap);
+        if constexpr(!std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value)
+        {
+            // The blocks of other can not be released through our allocator
+            if(get_allocator() != other.get_allocator())
+            {
+                copy_from(other);
+                return *this;
+            }
+        }
 
-        void shrink_to_fit() noexcept;
+        destroy();
+        if constexpr(std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value)
+            *alloc() = std::move(*other.alloc());
+        d = std::exchange(other.d, data{});
 
-        size_type capacity() const noexcept;
+        return *this;
+    }
 
-        // Modifiers
-        void clear() noexcept;
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>& DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::operator=(std::initializer_list<bool> ilist)
+    {
+        assign(ilist);
 
-        iterator insert(const_iterator pos, bool value);
-        iterator insert(const_iterator pos, size_type count, bool value);
-        template<typename Iter, typename = std::enable_if_t<detail::is_input_iterator_v<Iter>>>
-        iterator insert(const_iterator pos, Iter first, Iter last);
-        iterator insert(const_iterator pos, std::initializer_list<bool> ilist);
+        return *this;
+    }
 
-        template<class... Args>
-        iterator emplace(const_iterator pos, Args&& ... args);
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    template<typename Expr, typename>
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>& DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::operator=(Expr const& expr)
+    {
+        assign_expression(expr);
 
-        iterator erase(const_iterator pos);
-        iterator erase(const_iterator first, const_iterator last);
+        return *this;
+    }
 
-        void push_back(bool value);
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::assign(size_type count, bool value)
+    {
+        init_blocks(count, value);
+    }
 
-        void pop_back();
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    template<typename Iter, typename>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::assign(Iter first, Iter last)
+    {
+        size_t size = std::distance(first, last);
+        if(size > capacity())
+            reserve(size);
+        detach();
+        set_size(size);
+        std::copy(first, last, begin());
+        clear_padding();
+    }
 
-        template<class... Args>
-        reference emplace_back(Args&& ... args);
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::assign(std::initializer_list<bool> ilist)
+    {
+        size_t size = ilist.size();
+        if(size > capacity())
+            reserve(size);
+        detach();
+        set_size(size);
+        std::copy(ilist.begin(), ilist.end(), begin());
+        clear_padding();
+    }
 
-        void resize(size_type count);
-        void resize(size_type count, value_type value);
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::reference DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::at(size_type pos)
+    {
+        using namespace std::literals;
 
-        void swap(DynamicBitset& other) noexcept;
+        if(pos < 0 || pos >= size())
+            throw std::out_of_range("DynamicBitset::at out of range, pos given was "s + std::to_string(pos));
+        return *(begin() + pos);
+    }
 
-        void flip();
-        void flip(size_type n);
-        void flip(const_iterator it);
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::const_reference DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::at(size_type pos) const
+    {
+        using namespace std::literals;
 
-        static void swap(reference x, reference y);
+        if(pos < 0 || pos >= size())
+            throw std::out_of_range("DynamicBitset::at out of range, pos given was "s + std::to_string(pos));
+        return *(begin() + pos);
+    }
 
-        // Operators
-        DynamicBitset& operator&=(DynamicBitset const& b);
-        DynamicBitset& operator|=(DynamicBitset const& b);
-        DynamicBitset& operator^=(DynamicBitset const& b);
-        DynamicBitset& operator<<=(size_type n);
-        DynamicBitset& operator>>=(size_type n);
-        DynamicBitset operator<<(size_type n) const;
-        DynamicBitset operator>>(size_type n) const;
-        DynamicBitset operator~() const;
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::reference DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::front()
+    {
+        return *begin();
+    }
 
-        reference operator[](size_type pos);
-        bool operator[](size_type pos) const;
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::const_reference DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::front() const
+    {
+        return *begin();
+    }
 
-        // Member functions
-        allocator_type get_allocator() const;
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::reference DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::back()
+    {
+        return *(end() - 1);
+    }
 
-        bool any() const;
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::const_reference DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::back() const
+    {
+        return *(end() - 1);
+    }
 
-        bool none() const;
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::iterator DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::end() noexcept(!CopyOnWrite)
+    {
+        return begin() + size();
+    }
 
-        size_type find_first() const;
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::const_iterator DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::end() const noexcept
+    {
+        return begin() + size();
+    }
 
-        size_type find_next(size_type pos) const;
-        size_type find_next(const_iterator it) const;
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::const_iterator DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::cend() const noexcept
+    {
+        return cbegin() + size();
+    }
 
-        size_type popcount() const;
-        size_type popcount(const_iterator pos, size_type n) const;
-        size_type popcount(const_iterator first, const_iterator last) const;
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::reverse_iterator DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::rbegin() noexcept(!CopyOnWrite)
+    {
+        return reverse_iterator(end());
+    }
 
-    private:
-        void destroy() noexcept;
-        void grow(size_type size);
-        allocator_type* alloc() noexcept { return reinterpret_cast<allocator_type*>(this); }
-        allocator_type const* alloc() const noexcept { return reinterpret_cast<allocator_type const*>(this); }
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::const_reverse_iterator DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::rbegin() const noexcept
+    {
+        return const_reverse_iterator(end());
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::const_reverse_iterator DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::crbegin() const noexcept
+    {
+        return const_reverse_iterator(cend());
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::reverse_iterator DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::rend() noexcept(!CopyOnWrite)
+    {
+        return reverse_iterator(begin());
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::const_reverse_iterator DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::rend() const noexcept
+    {
+        return const_reverse_iterator(begin());
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::const_reverse_iterator DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::crend() const noexcept
+    {
+        return const_reverse_iterator(cbegin());
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    bool DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::empty() const noexcept
+    {
+        return size() == 0;
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::size_type DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::size() const noexcept
+    {
+        return d.size & ~heap_flag;
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::size_type DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::max_size() const noexcept
+    {
+        // Bit positions must stay representable as iterator differences
+        const size_type limit = size_type(std::numeric_limits<difference_type>::max()) - bits_per_block + 1;
+        const size_type max_vectors = vector_traits::max_size(vector_allocator(*alloc())) - header_blocks / blocks_per_vector;
+        return max_vectors > limit / (bits_per_block * blocks_per_vector) ? limit : max_vectors * blocks_per_vector * bits_per_block;
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::shrink_to_fit() noexcept
+    {
+        if(is_inline())
+            return;
+
+        size_t num_block = num_blocks();
+        if(num_block <= inline_blocks)
+        {
+            // Move back into the object, the heap buffer is released for good
+            Block* const start = d.storage.heap.start;
+            Block* const end = d.storage.heap.capacity;
+            const size_type count = size();
+            d = data{};
+            std::copy_n(start, num_block, d.storage.local);
+            set_size(count);
+            release_blocks(start, end - start);
+        }
+        else if(round_to_vector(num_block) < block_capacity())
+        {
+            try
+            {
+                num_block = round_to_vector(num_block);
+                Block* temp = allocate_blocks(num_block);
+                std::copy_n(blocks(), num_blocks(), temp);
+                destroy();
+                d.storage.heap.start = temp;
+                d.storage.heap.capacity = temp + num_block;
+                clear_padding();
+            }
+            catch(...)
+            {
+                // shrink_to_fit is a non-binding request, keep the current buffer
+            }
+        }
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::size_type DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::capacity() const noexcept
+    {
+        return block_capacity() * bits_per_block;
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::size_type DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::num_blocks() const noexcept
+    {
+        return ceil_div<bits_per_block>(size());
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    Block DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::block(size_type i) const noexcept
+    {
+        return blocks()[i];
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::clear() noexcept
+    {
+        resize_padded(0);
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::iterator DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::insert(const_iterator pos, bool value)
+    {
+        return insert(pos, 1, value);
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::grow(size_type size)
+    {
+        if(size > capacity())
+            reserve(std::min(std::max<size_type>(GrowthPolicy::next_capacity(capacity(), size), size), max_size()));
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::iterator DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::insert(const_iterator pos, size_type count, bool value)
+    {
+        const size_type index = pos - cbegin();
+        if(count > max_size() - size())
+            throw std::length_error("DynamicBitset::insert would exceed max_size()");
+        grow(size() + count);
+        detach();
+        const size_type moved = size() - index;
+        resize_padded(size() + count);
+        move_bits(blocks(), index + count, index, moved);
+        detail::fill_bits<BitOrder>(blocks(), index, count, value);
+        return begin() + index;
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    template<typename Iter, typename>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::iterator DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::insert(const_iterator pos, Iter first, Iter last)
+    {
+        const size_type index = pos - cbegin();
+        if constexpr(detail::is_forward_iterator_v<Iter>)
+        {
+            const size_type count = std::distance(first, last);
+            if(count > max_size() - size())
+                throw std::length_error("DynamicBitset::insert would exceed max_size()");
+            grow(size() + count);
+            detach();
+            const size_type moved = size() - index;
+            resize_padded(size() + count);
+            move_bits(blocks(), index + count, index, moved);
+            std::copy(first, last, begin() + index);
+        }
+        else
+        {
+            for(size_type i = index; first != last; ++first, ++i)
+                insert(cbegin() + i, static_cast<bool>(*first));
+        }
+        return begin() + index;
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::iterator DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::insert(const_iterator pos, std::initializer_list<bool> ilist)
+    {
+        return insert(pos, ilist.begin(), ilist.end());
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    template<class... Args>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::iterator DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::emplace(const_iterator pos, Args&& ... args)
+    {
+        return insert(pos, bool(std::forward<Args>(args)...));
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::iterator DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::erase(const_iterator pos)
+    {
+        return erase(pos, pos + 1);
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::iterator DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::erase(const_iterator first, const_iterator last)
+    {
+        const size_type index = first - cbegin();
+        const size_type count = last - first;
+        detach();
+        move_bits(blocks(), index, index + count, size() - index - count);
+        resize_padded(size() - count);
+        return begin() + index;
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::push_back(bool value)
+    {
+        check_length(size() + 1);
+        grow(size() + 1);
+        detach();
+        resize_padded(size() + 1);
+        back() = value;
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::pop_back()
+    {
+        detach();
+        resize_padded(size() - 1);
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    template<class... Args>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::reference DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::emplace_back(Args&& ... args)
+    {
+        push_back(bool(std::forward<Args>(args)...));
+        return back();
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::resize(size_type count)
+    {
+        resize(count, false);
+    }
 
-    private:
-        struct data
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::resize(size_type count, value_type value)
+    {
+        const size_type old_size = size();
+        if(old_size == 0 && count > capacity())
         {
-            std::byte* start = nullptr;
-            std::byte* capacity = nullptr;
-            uintptr_t size = 0;
-        };
-        data d;
-    };
+            init_blocks(count, value);
+            return;
+        }
+        reserve(count);
+        detach();
+        resize_padded(count);
+        if(count > old_size && value)
+            detail::fill_bits<BitOrder>(blocks(), old_size, count - old_size, true);
+    }
 
-    template<typename Allocator>
-    typename DynamicBitset<Allocator>::size_type
-    DynamicBitset<Allocator>::popcount(const_iterator pos, size_type n) const
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::swap(DynamicBitset& other) noexcept
     {
-        size_type sum = 0;
-        const auto end = pos + n;
+        if constexpr(std::allocator_traits<Allocator>::propagate_on_container_swap::value)
+        {
+            using std::swap;
+            swap(*alloc(), *other.alloc());
+        }
+        std::swap(d, other.d);
+    }
 
-        #ifdef DB_OS_WINDOWS
-        while (pos != end) {
-            if (end - pos >= 64) {
-                sum += __popcnt64(reinterpret_cast<__int64>(pos));
-                pos += 64;
-            } else if (end - pos >= 32) {
-                sum += __popcnt(reinterpret_cast<__int32>(pos));
-                pos += 32;
-            } else if (end - pos >= 16) {
-                sum += __popcnt16(reinterpret_cast<__int16>(pos));
-                pos += 16;
-            } else {
-                while (pos != end) {
-                    sum += *pos++;
-                }
-            }
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::flip()
+    {
+        detach();
+        Block* const first = blocks();
+        for(Block* block = first; block != first + num_blocks(); ++block)
+            *block = Block(~*block);
+        clear_padding();
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::rotate_left(size_type n)
+    {
+        if(empty() || n % size() == 0)
+            return;
+        if(size() % bits_per_block == 0)
+        {
+            detach();
+            rotate_blocks(n % size());
         }
-        #elif defined(DB_OS_LINUX)
-        while(pos != end)
+        else
+            rotate(cbegin(), cbegin() + (size() - n % size()), cend());
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::rotate_right(size_type n)
+    {
+        if(empty() || n % size() == 0)
+            return;
+        rotate_left(size() - n % size());
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::iterator DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::rotate(const_iterator first, const_iterator middle, const_iterator last)
+    {
+        const size_type index = first - cbegin();
+        const size_type split = middle - cbegin();
+        const size_type end = last - cbegin();
+        detach();
+        // Block swaps put the shorter side in its final place until it fits in one block,
+        // then that side is carried in a scratch word while the other is moved over it
+        Block* const data = blocks();
+        size_type low = index, high = end;
+        while(split - low >= bits_per_block && high - split >= bits_per_block)
         {
-            if(end - pos >= sizeof(unsigned long long) * CHAR_BIT)
+            const size_type left = split - low, right = high - split;
+            if(left <= right)
             {
-                sum += __builtin_popcountll(*reinterpret_cast<uint64_t*>(pos.byte));
-                pos += 64;
+                swap_bits(data, low, high - left, left);
+                high -= left;
             }
-            else if(end - pos >= sizeof(unsigned long) * CHAR_BIT)
+            else
             {
-                sum += __builtin_popcountl(*reinterpret_cast<uint32_t*>(pos.byte));
-                pos += 32;
+                swap_bits(data, low, split, right);
+                low += right;
             }
-            else if(end - pos >= sizeof(unsigned int) * CHAR_BIT)
+        }
+        const size_type left = split - low, right = high - split;
+        if(left != 0 && right != 0)
+        {
+            if(left < bits_per_block)
             {
-                sum += __builtin_popcount(*reinterpret_cast<uint16_t*>(pos.byte));
-                pos += 16;
+                const Block carry = load_bits(data, low, left);
+                move_bits(data, low, split, right);
+                store_bits(data, high - left, carry, left);
             }
             else
             {
-                while(pos != end)
-                {
-                    sum += *pos++;
-                }
+                const Block carry = load_bits(data, split, right);
+                move_bits(data, low + right, low, left);
+                store_bits(data, low, carry, right);
             }
         }
-        #else
-        while(pos != end){
-            sum += *pos++;
-        }
-        #endif
-        return sum;
+        return begin() + (index + end - split);
     }
 
-    template<typename Allocator>
-    DynamicBitset<Allocator>::DynamicBitset() noexcept(std::is_nothrow_default_constructible_v<Allocator>) {}
-
-    template<typename Allocator>
-    DynamicBitset<Allocator>::DynamicBitset(
-        const Allocator& alloc) noexcept(std::is_nothrow_copy_constructible_v<Allocator>) :
-        Allocator{alloc} {}
-
-    template<typename Allocator>
-    DynamicBitset<Allocator>::DynamicBitset(DynamicBitset::size_type count, const Allocator& alloc) :
-        Allocator{alloc}
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::flip(size_type n)
     {
-        reserve(count);
-        d.size = count;
-        memset(d.start, 0, ceil_div<8>(d.size));
+        (*this)[n].flip();
     }
 
-    template<typename Allocator>
-    void DynamicBitset<Allocator>::reserve(DynamicBitset::size_type new_cap)
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::flip(const_iterator it)
     {
-        if(new_cap > (d.capacity - d.start) * 8)
-        {
-            size_t num_byte = ceil_div<8>(new_cap);
-            std::byte* temp = Allocator::allocate(num_byte);
-            memcpy(temp, d.start, ceil_div<8>(d.size));
-            destroy();
-            d.start = temp;
-            d.capacity = temp + num_byte;
-        }
+        (*this)[it - cbegin()].flip();
     }
 
-    template<typename Allocator>
-    void DynamicBitset<Allocator>::destroy() noexcept
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::swap(reference x, reference y)
     {
-        if(d.start)
-            Allocator::deallocate(d.start, d.capacity - d.start);
+        bool temp = x;
+        x = y;
+        y = temp;
     }
 
-    template<typename Allocator>
-    typename DynamicBitset<Allocator>::size_type DynamicBitset<Allocator>::popcount() const
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>& DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::operator&=(DynamicBitset const& b)
     {
-        return popcount(cbegin(), d.size);
+        return apply_binary<detail::simd::and_op>(b);
     }
 
-    template<typename Allocator>
-    typename DynamicBitset<Allocator>::const_iterator DynamicBitset<Allocator>::cbegin() const noexcept
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>& DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::operator|=(DynamicBitset const& b)
     {
-        return const_iterator(d.start, 0);
+        return apply_binary<detail::simd::or_op>(b);
     }
 
-    template<typename Allocator>
-    template<size_t N>
-    DynamicBitset<Allocator>::DynamicBitset(bool const (& bools)[N], Allocator const& alloc) :
-        Allocator{alloc}
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>& DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::operator^=(DynamicBitset const& b)
     {
-        reserve(N);
-        d.size = N;
-        auto it = begin();
-        for(bool b : bools)
-            *it++ = b;
+        return apply_binary<detail::simd::xor_op>(b);
     }
 
-    template<typename Allocator>
-    typename DynamicBitset<Allocator>::iterator DynamicBitset<Allocator>::begin() noexcept
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>& DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::operator-=(DynamicBitset const& b)
     {
-        return iterator(d.start, 0);
+        return apply_binary<detail::simd::and_not_op>(b);
     }
 
-    template<typename Allocator>
-    typename DynamicBitset<Allocator>::const_iterator DynamicBitset<Allocator>::begin() const noexcept
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>& DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::and_not(DynamicBitset const& b)
     {
-        return cbegin();
+        return apply_binary<detail::simd::and_not_op>(b);
     }
 
-    template<typename Allocator>
-    DynamicBitset<Allocator>::DynamicBitset(DynamicBitset::size_type count, bool value, const Allocator& alloc) :
-        Allocator(alloc)
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>& DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::nand(DynamicBitset const& b)
     {
-        reserve(count);
-        d.size = count;
-        memset(d.start, value ? 0xFF : 0, ceil_div<8>(d.size));
+        return apply_binary<detail::simd::nand_op>(b);
     }
 
-    template<typename Allocator>
-    template<typename Iter, typename>
-    DynamicBitset<Allocator>::DynamicBitset(Iter first, Iter last, Allocator const& alloc) :
-        Allocator(alloc)
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>& DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::nor(DynamicBitset const& b)
     {
-        auto size = std::distance(first, last);
-        reserve(size);
-        d.size = size;
-        std::copy(first, last, begin());
+        return apply_binary<detail::simd::nor_op>(b);
     }
 
-    template<typename Allocator>
-    DynamicBitset<Allocator>::DynamicBitset(DynamicBitset const& other) :
-        Allocator(other)
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>& DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::xnor(DynamicBitset const& b)
     {
-        reserve(other.d.size);
-        d.size = other.d.size;
-        memcpy(d.start, other.d.start, ceil_div<8>(d.size));
+        return apply_binary<detail::simd::xnor_op>(b);
     }
 
-    template<typename Allocator>
-    DynamicBitset<Allocator>::DynamicBitset(DynamicBitset const& other, const Allocator& alloc):
-        Allocator(other)
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    template<typename Expr, typename>
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>& DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::operator&=(Expr const& expr)
     {
-        reserve(other.d.size);
-        d.size = other.d.size;
-        memcpy(d.start, other.d.start, ceil_div<8>(d.size));
+        return *this = (*this & expr);
     }
 
-    template<typename Allocator>
-    DynamicBitset<Allocator>::DynamicBitset(DynamicBitset&& other) noexcept :
-        Allocator(std::move(other))
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    template<typename Expr, typename>
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>& DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::operator|=(Expr const& expr)
     {
-        d = other.d;
-        other.d.start = other.d.capacity = nullptr;
-        other.d.size = 0;
+        return *this = (*this | expr);
     }
 
-    template<typename Allocator>
-    DynamicBitset<Allocator>::DynamicBitset(DynamicBitset&& other,
-                                            const Allocator& alloc) noexcept(std::is_nothrow_copy_constructible_v<Allocator>)
-        :
-        Allocator(std::move(other))
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    template<typename Expr, typename>
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>& DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::operator^=(Expr const& expr)
     {
-        d = other.d;
-        other.d.start = other.d.capacity = nullptr;
-        other.d.size = 0;
+        return *this = (*this ^ expr);
     }
 
-    template<typename Allocator>
-    DynamicBitset<Allocator>::DynamicBitset(std::initializer_list<bool> ilist, const Allocator& alloc) :
-        DynamicBitset(ilist.begin(), ilist.end(), alloc) {}
-
-    template<typename Allocator>
-    DynamicBitset<Allocator>::~DynamicBitset()
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    template<typename Expr, typename>
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>& DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::operator-=(Expr const& expr)
     {
-        destroy();
+        return *this = (*this - expr);
     }
 
-    template<typename Allocator>
-    DynamicBitset<Allocator>& DynamicBitset<Allocator>::operator=(DynamicBitset const& other)
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>& DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::operator<<=(size_type n)
     {
-        if(std::allocator_traits<Allocator>::propagate_on_container_copy_assignment::value)
+        detach();
+        Block* const first = blocks();
+        const size_type count = num_blocks();
+        if(n >= size())
         {
-            if(get_allocator() != other.get_allocator())
-                destroy();
-            *alloc() = *other.alloc();
-            reserve(other.d.size);
-            d.size = other.d.size;
-            memcpy(d.start, other.d.start, ceil_div<8>(d.size));
+            std::fill(first, first + count, Block(0));
+            return *this;
         }
-        else
+
+        #ifdef DB_SIMD_DISPATCH
+        // With lsb_first on x86, the blocks are one little-endian bit string whatever their type
+        if constexpr(std::is_same_v<BitOrder, lsb_first>)
         {
-            reserve(other.d.size);
-            d.size = other.d.size;
-            memcpy(d.start, other.d.start, ceil_div<8>(d.size));
+            detail::simd::shift<true>(reinterpret_cast<std::byte*>(first), count * sizeof(Block), n);
+            clear_padding();
+            return *this;
         }
+        #endif
 
+        // Word moves plus a funnel shift carrying the high bits of the lower neighbour, from the top down
+        const size_type words = n / bits_per_block;
+        const size_type offset = n % bits_per_block;
+        if(offset == 0)
+            std::memmove(first + words, first, (count - words) * sizeof(Block));
+        else
+        {
+            for(size_type i = count - 1; i > words; --i)
+                first[i] = Block(order::shift_up(first[i - words], offset) | order::shift_down(first[i - words - 1], bits_per_block - offset));
+            first[words] = order::shift_up(first[0], offset);
+        }
+        std::fill(first, first + words, Block(0));
+        clear_padding();
         return *this;
     }
 
-    template<typename Allocator>
-    DynamicBitset<Allocator>& DynamicBitset<Allocator>::operator=(DynamicBitset&& other) noexcept
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>& DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::operator>>=(size_type n)
     {
-        if(std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value)
+        detach();
+        Block* const first = blocks();
+        const size_type count = num_blocks();
+        if(n >= size())
         {
-            if(get_allocator() != other.get_allocator())
-                destroy();
-            *alloc() = *other.alloc();
-            reserve(other.d.size);
-            d.size = other.d.size;
-            memcpy(d.start, other.d.start, ceil_div<8>(d.size));
+            std::fill(first, first + count, Block(0));
+            return *this;
         }
-        else
+
+        #ifdef DB_SIMD_DISPATCH
+        if constexpr(std::is_same_v<BitOrder, lsb_first>)
         {
-            d = other.d;
-            other.d.start = other.d.capacity = nullptr;
-            other.d.size = 0;
+            detail::simd::shift<false>(reinterpret_cast<std::byte*>(first), count * sizeof(Block), n);
+            return *this;
         }
+        #endif
 
+        // Mirror of <<=, from the bottom up. The padding is zero, so the top block needs no mask.
+        const size_type words = n / bits_per_block;
+        const size_type offset = n % bits_per_block;
+        const size_type kept = count - words;
+        if(offset == 0)
+            std::memmove(first, first + words, kept * sizeof(Block));
+        else
+        {
+            for(size_type i = 0; i + 1 < kept; ++i)
+                first[i] = Block(order::shift_down(first[i + words], offset) | order::shift_up(first[i + words + 1], bits_per_block - offset));
+            first[kept - 1] = order::shift_down(first[count - 1], offset);
+        }
+        std::fill(first + kept, first + count, Block(0));
         return *this;
     }
 
-    template<typename Allocator>
-    DynamicBitset<Allocator>& DynamicBitset<Allocator>::operator=(std::initializer_list<bool> ilist)
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    template<typename Expr>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::assign_expression(Expr const& expr)
     {
-        reserve(ilist.size());
-        d.size = ilist.size();
-        std::copy(ilist.begin(), ilist.end(), begin());
+        const size_type size = expr.size();
+        const unsigned aliasing = expr.aliasing(blocks());
+        const bool both_ways = (aliasing & detail::reads_below) && (aliasing & detail::reads_above);
+        if(size > capacity() || is_shared() || both_ways)
+        {
+            // The expression may read our blocks, they must outlive the evaluation
+            DynamicBitset temp(get_allocator());
+            temp.reserve(size);
+            temp.assign_expression(expr);
+            swap(temp);
+            return;
+        }
 
-        return *this;
+        set_size(size);
+        Block* const first = blocks();
+        const size_type count = num_blocks();
+        const size_type unchecked = std::min(count, expr.min_blocks());
+        if(aliasing & detail::reads_below)
+        {
+            for(size_type i = count; i > unchecked; --i)
+                first[i - 1] = expr.word(i - 1);
+            for(size_type i = unchecked; i > 0; --i)
+                first[i - 1] = expr.word_unchecked(i - 1);
+        }
+        else
+        {
+            size_type i = 0;
+            for(; i < unchecked; ++i)
+                first[i] = expr.word_unchecked(i);
+            for(; i < count; ++i)
+                first[i] = expr.word(i);
+        }
+        std::fill(first + count, first + padded_blocks(), Block(0));
+        clear_padding();
     }
 
-    template<typename Allocator>
-    void DynamicBitset<Allocator>::assign(size_type count, bool value)
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::assign_ternary(DynamicBitset const& a, DynamicBitset const& b, DynamicBitset const& c, uint8_t table)
     {
-        reserve(count);
-        d.size = count;
-        memset(d.start, value ? 0xFF : 0, ceil_div<8>(d.size));
+        const size_type size = a.size();
+        if(size > capacity() || is_shared())
+        {
+            DynamicBitset temp(get_allocator());
+            temp.reserve(size);
+            temp.assign_ternary(a, b, c, table);
+            swap(temp);
+            return;
+        }
+
+        // Read before set_size, *this may be b or c
+        Block const* const pa = a.blocks();
+        Block const* const pb = b.blocks();
+        Block const* const pc = c.blocks();
+        const size_type count_b = b.num_blocks();
+        const size_type count_c = c.num_blocks();
+        const bool aligned = kernel_alignment > 1 && !is_inline() && !a.is_inline() && !b.is_inline() && !c.is_inline();
+        const size_type padded_b = b.padded_blocks();
+        const size_type padded_c = c.padded_blocks();
+        set_size(size);
+        Block* const first = blocks();
+        const size_type count = num_blocks();
+        size_type common;
+        if(aligned)
+        {
+            // a has the size of *this, so the same padded blocks
+            common = std::min({padded_blocks(), padded_b, padded_c});
+            detail::simd::ternary<kernel_alignment>(reinterpret_cast<std::byte*>(first), reinterpret_cast<std::byte const*>(pa),
+                                                    reinterpret_cast<std::byte const*>(pb), reinterpret_cast<std::byte const*>(pc),
+                                                    common * sizeof(Block), table);
+        }
+        else
+        {
+            common = std::min({count, count_b, count_c});
+            detail::simd::ternary(reinterpret_cast<std::byte*>(first), reinterpret_cast<std::byte const*>(pa),
+                                  reinterpret_cast<std::byte const*>(pb), reinterpret_cast<std::byte const*>(pc),
+                                  common * sizeof(Block), table);
+        }
+        // b and c are zero-extended
+        for(size_type i = common; i < count; ++i)
+            first[i] = detail::simd::ternary_word(pa[i], i < count_b ? pb[i] : Block(0), i < count_c ? pc[i] : Block(0), table);
+        std::fill(first + count, first + padded_blocks(), Block(0));
+        clear_padding();
     }
 
-    template<typename Allocator>
-    template<typename Iter, typename>
-    void DynamicBitset<Allocator>::assign(Iter first, Iter last)
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    template<typename Op>
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>& DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::apply_binary(DynamicBitset const& b)
     {
-        size_t size = std::distance(first, last);
-        if(size > capacity())
-            reserve(size);
-        std::copy(first, last, begin());
-        d.size = size;
+        detach();
+        Block* const first = blocks();
+        size_type common;
+        if(kernel_alignment > 1 && !is_inline() && !b.is_inline())
+        {
+            common = std::min(padded_blocks(), b.padded_blocks());
+            detail::simd::binary<Op, kernel_alignment>(reinterpret_cast<std::byte*>(first), reinterpret_cast<std::byte const*>(b.blocks()), common * sizeof(Block));
+        }
+        else
+        {
+            common = std::min(num_blocks(), b.num_blocks());
+            detail::simd::binary<Op>(reinterpret_cast<std::byte*>(first), reinterpret_cast<std::byte const*>(b.blocks()), common * sizeof(Block));
+        }
+        // Nothing to do when zero is an identity of Op, as for |, ^ and and-not
+        constexpr bool keeps_tail = Op::scalar(Block(~Block(0)), Block(0)) == Block(~Block(0)) && Op::scalar(Block(0), Block(0)) == Block(0);
+        if constexpr(!keeps_tail)
+            std::transform(first + std::min(common, num_blocks()), first + num_blocks(), first + std::min(common, num_blocks()), [](Block block) { return Op::scalar(block, Block(0)); });
+        // b may be longer than size() inside the last block or vector, and Op may have set padding bits
+        clear_padding();
+        return *this;
     }
 
-    template<typename Allocator>
-    void DynamicBitset<Allocator>::assign(std::initializer_list<bool> ilist)
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::reference DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::operator[](size_type pos)
     {
-        size_t size = ilist.size();
-        if(size > capacity())
-            reserve(size);
-        std::copy(ilist.begin(), ilist.end(), begin());
-        d.size = size;
+        detach();
+        return reference(blocks() + pos / bits_per_block, pos % bits_per_block);
     }
 
-    template<typename Allocator>
-    typename DynamicBitset<Allocator>::reference DynamicBitset<Allocator>::at(size_type pos)
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    bool DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::operator[](size_type pos) const
     {
-        using namespace std::literals;
-        
-        if(pos < 0 || pos >= size())
-            throw std::out_of_range("DynamicBitset::at out of range, pos given was "s + std::to_string(pos));
-        return *(begin() + pos);
+        return (blocks()[pos / bits_per_block] & bit_mask(pos % bits_per_block)) != 0;
     }
 
-    template<typename Allocator>
-    typename DynamicBitset<Allocator>::const_reference DynamicBitset<Allocator>::at(size_type pos) const
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::allocator_type DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::get_allocator() const
     {
-        using namespace std::literals;
-
-        if(pos < 0 || pos >= size())
-            throw std::out_of_range("DynamicBitset::at out of range, pos given was "s + std::to_string(pos));
-        return *(begin() + pos);
+        return *alloc();
     }
 
-    template<typename Allocator>
-    typename DynamicBitset<Allocator>::reference DynamicBitset<Allocator>::front()
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    bool DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::any() const
     {
-        return *begin();
+        Block const* const first = blocks();
+        return std::any_of(first, first + num_blocks(), [](Block block) { return block != 0; });
     }
 
-    template<typename Allocator>
-    typename DynamicBitset<Allocator>::const_reference DynamicBitset<Allocator>::front() const
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    bool DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::none() const
     {
-        return *begin();
+        return !any();
     }
 
-    template<typename Allocator>
-    typename DynamicBitset<Allocator>::reference DynamicBitset<Allocator>::back()
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::ones_view DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::ones() const noexcept
     {
-        return *(end() - 1);
+        return ones_view(blocks(), num_blocks());
     }
 
-    template<typename Allocator>
-    typename DynamicBitset<Allocator>::const_reference DynamicBitset<Allocator>::back() const
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::size_type DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::find_first() const noexcept
     {
-        return *(end() - 1);
+        return find_from<true>(0);
     }
 
-    template<typename Allocator>
-    typename DynamicBitset<Allocator>::iterator DynamicBitset<Allocator>::end() noexcept
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::size_type DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::find_next(size_type pos) const noexcept
     {
-        return begin() + size();
+        return pos >= size() ? npos : find_from<true>(pos + 1);
     }
 
-    template<typename Allocator>
-    typename DynamicBitset<Allocator>::const_iterator DynamicBitset<Allocator>::end() const noexcept
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::size_type DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::find_next(const_iterator it) const noexcept
     {
-        return begin() + size();
+        return find_next(size_type(it - cbegin()));
     }
 
-    template<typename Allocator>
-    typename DynamicBitset<Allocator>::const_iterator DynamicBitset<Allocator>::cend() const noexcept
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::size_type DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::find_first_zero() const noexcept
     {
-        return cbegin() + size();
+        return find_from<false>(0);
     }
 
-    template<typename Allocator>
-    typename DynamicBitset<Allocator>::reverse_iterator DynamicBitset<Allocator>::rbegin() noexcept
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::size_type DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::find_next_zero(size_type pos) const noexcept
     {
-        return reverse_iterator(end());
+        return pos >= size() ? npos : find_from<false>(pos + 1);
     }
 
-    template<typename Allocator>
-    typename DynamicBitset<Allocator>::const_reverse_iterator DynamicBitset<Allocator>::rbegin() const noexcept
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::size_type DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::find_next_zero(const_iterator it) const noexcept
     {
-        return reverse_iterator(end());
+        return find_next_zero(size_type(it - cbegin()));
     }
 
-    template<typename Allocator>
-    typename DynamicBitset<Allocator>::const_reverse_iterator DynamicBitset<Allocator>::crbegin() const noexcept
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    template<bool Value>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::size_type DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::find_from(size_type pos) const noexcept
     {
-        return reverse_iterator(rend());
+        if(pos >= size())
+            return npos;
+
+        // Zeros are searched as the ones of the inverted blocks
+        constexpr Block invert = Value ? Block(0) : Block(~Block(0));
+        Block const* const first = blocks();
+        const size_type count = num_blocks();
+        size_type i = pos / bits_per_block;
+        Block word = Block((first[i] ^ invert) & ~head_mask(pos % bits_per_block));
+        if(word == 0)
+        {
+            // Sparse results : skip whole blocks a vector at a time, then resolve the block
+            ++i;
+            i += detail::simd::skip<Value ? 0x00 : 0xFF>(reinterpret_cast<std::byte const*>(first + i), (count - i) * sizeof(Block)) / sizeof(Block);
+            if(i == count)
+                return npos;
+            while(first[i] == invert)
+                ++i;
+            word = Block(first[i] ^ invert);
+        }
+        // The padding is zero, so a set bit is below size() but a zero bit may be padding
+        const size_type result = i * bits_per_block + order::first(word);
+        return Value || result < size() ? result : npos;
     }
 
-    template<typename Allocator>
-    typename DynamicBitset<Allocator>::reverse_iterator DynamicBitset<Allocator>::rend() noexcept
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::size_type DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::find_zero_run(size_type k, size_type from) const noexcept
     {
-        return reverse_iterator(begin());
+        return find_run<false>(k, from);
     }
 
-    template<typename Allocator>
-    typename DynamicBitset<Allocator>::const_reverse_iterator DynamicBitset<Allocator>::rend() const noexcept
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::size_type DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::find_one_run(size_type k, size_type from) const noexcept
     {
-        return reverse_iterator(begin());
+        return find_run<true>(k, from);
     }
 
-    template<typename Allocator>
-    typename DynamicBitset<Allocator>::const_reverse_iterator DynamicBitset<Allocator>::crend() const noexcept
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    template<bool Value>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::size_type DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::find_run(size_type k, size_type from) const noexcept
     {
-        return reverse_iterator(cbegin());
+        if(from > size() || k > size() - from)
+            return npos;
+        if(k == 0)
+            return from;
+
+        constexpr Block invert = Value ? Block(0) : Block(~Block(0));
+        constexpr Block full = Block(~Block(0));
+        Block const* const first = blocks();
+        const size_type count = num_blocks();
+        // Run of the searched value reaching the end of the previous block
+        size_type run = 0, start = 0;
+        for(size_type i = from / bits_per_block; i < count; ++i)
+        {
+            // Searched bits set, those before from or past size() cleared
+            Block word = Block(first[i] ^ invert);
+            if(i == from / bits_per_block)
+                word &= Block(~head_mask(from % bits_per_block));
+            if(i == count - 1)
+                word &= head_mask(size() - i * bits_per_block);
+
+            if(word == full)
+            {
+                if(run == 0)
+                    start = i * bits_per_block;
+                run += bits_per_block;
+                if(run >= k)
+                    return start;
+                continue;
+            }
+            if(word == 0)
+            {
+                // Breaks any run, as do the blocks after it the skip kernel passes over
+                run = 0;
+                i += detail::simd::skip<Value ? 0x00 : 0xFF>(reinterpret_cast<std::byte const*>(first + i + 1), (count - i - 1) * sizeof(Block)) / sizeof(Block);
+                continue;
+            }
+
+            // The run from the previous blocks, extended by the leading bits
+            const size_type lead = order::first(Block(~word));
+            if(run + lead >= k)
+                return run == 0 ? i * bits_per_block : start;
+            // Runs within the block : after the reduction, bit p is set when bits p to p + k - 1 all are
+            if(k <= bits_per_block)
+            {
+                Block runs = word;
+                for(size_type length = 1; length < k;)
+                {
+                    const size_type step = std::min(length, k - length);
+                    runs &= order::shift_down(runs, step);
+                    length += step;
+                }
+                if(runs != 0)
+                    return i * bits_per_block + order::first(runs);
+            }
+            // The trailing bits start the next run
+            run = bits_per_block - 1 - order::last(Block(~word));
+            start = (i + 1) * bits_per_block - run;
+        }
+        return npos;
     }
 
-    template<typename Allocator>
-    bool DynamicBitset<Allocator>::empty() const noexcept
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::size_type DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::find_last() const noexcept
     {
-        return size() == 0;
+        return find_before(size());
     }
 
-    template<typename Allocator>
-    typename DynamicBitset<Allocator>::size_type DynamicBitset<Allocator>::size() const noexcept
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::size_type DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::find_prev(size_type pos) const noexcept
     {
-        return d.size;
+        return find_before(std::min(pos, size()));
     }
 
-    template<typename Allocator>
-    typename DynamicBitset<Allocator>::size_type DynamicBitset<Allocator>::max_size() const noexcept
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::size_type DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::find_prev(const_iterator it) const noexcept
     {
-        return std::numeric_limits<size_type>::max();
+        return find_prev(size_type(it - cbegin()));
     }
 
-    template<typename Allocator>
-    void DynamicBitset<Allocator>::shrink_to_fit() noexcept
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::size_type DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::find_before(size_type pos) const noexcept
     {
-        auto new_cap = ceil_div<8>(size());
-        if(new_cap < ceil_div<8>(capacity()))
+        if(pos == 0)
+            return npos;
+
+        Block const* const first = blocks();
+        size_type i = (pos - 1) / bits_per_block;
+        Block word = Block(first[i] & head_mask((pos - 1) % bits_per_block + 1));
+        if(word == 0)
         {
-            size_t num_byte = new_cap;
-            std::byte* temp = Allocator::allocate(num_byte);
-            memcpy(temp, d.start, ceil_div<8>(d.size));
-            destroy();
-            d.start = temp;
-            d.capacity = temp + num_byte;
+            // Mirror of find_from : skip zero blocks backward, then resolve the block
+            const size_type bytes = detail::simd::skip_zeros_backward(reinterpret_cast<std::byte const*>(first), i * sizeof(Block));
+            i = (bytes + sizeof(Block) - 1) / sizeof(Block);
+            if(i == 0)
+                return npos;
+            while(first[i - 1] == 0)
+                --i;
+            word = first[--i];
         }
+        return i * bits_per_block + order::last(word);
     }
 
-    template<typename Allocator>
-    typename DynamicBitset<Allocator>::size_type DynamicBitset<Allocator>::capacity() const noexcept
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    Block DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::load_bits(Block const* blocks, size_type pos, size_type n) noexcept
     {
-        return (d.capacity - d.start) * 8;
+        const size_type offset = pos % bits_per_block;
+        blocks += pos / bits_per_block;
+        Block value = order::shift_down(blocks[0], offset);
+        if(offset != 0 && offset + n > bits_per_block)
+            value |= order::shift_up(blocks[1], bits_per_block - offset);
+        return Block(value & head_mask(n));
     }
 
-    template<typename Allocator>
-    void DynamicBitset<Allocator>::clear() noexcept
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::store_bits(Block* blocks, size_type pos, Block value, size_type n) noexcept
     {
-        d.size = 0;
+        const size_type offset = pos % bits_per_block;
+        const Block mask = head_mask(n);
+        blocks += pos / bits_per_block;
+        value &= mask;
+        blocks[0] = Block((blocks[0] & ~order::shift_up(mask, offset)) | order::shift_up(value, offset));
+        if(offset != 0 && offset + n > bits_per_block)
+            blocks[1] = Block((blocks[1] & ~order::shift_down(mask, bits_per_block - offset)) | order::shift_down(value, bits_per_block - offset));
     }
 
-    template<typename Allocator>
-    typename DynamicBitset<Allocator>::iterator DynamicBitset<Allocator>::insert(const_iterator pos, bool value)
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::move_bits(Block* blocks, size_type dst, size_type src, size_type n) noexcept
     {
-        grow(size()+1);
-        for(auto ptr = d.capacity-1; ptr > pos.byte; --ptr)
-            *ptr = ((*(ptr-1) & std::byte(0x01)) << 7) | (*ptr >> 1);
-        
-        *pos.byte = (*pos.byte & std::byte(~((1 << (7-pos.offset+1))-1)) ) | ((*pos.byte >> 1) & std::byte((1 << (7-pos.offset))-1)) | (std::byte(value?1:0) << (7-pos.offset));
-        
-        return iterator(pos.byte, pos.offset);
+        // Same semantics as memmove, one block-sized funnel shift at a time
+        if(dst < src)
+        {
+            for(size_type i = 0; i < n; i += bits_per_block)
+            {
+                const size_type chunk = std::min<size_type>(bits_per_block, n - i);
+                store_bits(blocks, dst + i, load_bits(blocks, src + i, chunk), chunk);
+            }
+        }
+        else if(dst > src)
+        {
+            for(size_type i = n; i > 0;)
+            {
+                const size_type chunk = std::min<size_type>(bits_per_block, i);
+                i -= chunk;
+                store_bits(blocks, dst + i, load_bits(blocks, src + i, chunk), chunk);
+            }
+        }
     }
 
-    template<typename Allocator>
-    void DynamicBitset<Allocator>::grow(size_type size)
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::swap_bits(Block* blocks, size_type a, size_type b, size_type n) noexcept
     {
-        if(size > capacity())
-            reserve(capacity()*1.5 + 1);
+        // The ranges [a, a + n) and [b, b + n) must not overlap
+        for(size_type i = 0; i < n; i += bits_per_block)
+        {
+            const size_type chunk = std::min<size_type>(bits_per_block, n - i);
+            const Block x = load_bits(blocks, a + i, chunk);
+            store_bits(blocks, a + i, load_bits(blocks, b + i, chunk), chunk);
+            store_bits(blocks, b + i, x, chunk);
+        }
     }
 
-    template<typename Allocator>
-    typename DynamicBitset<Allocator>::iterator DynamicBitset<Allocator>::insert(const_iterator pos, size_type count, bool value)
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::rotate_blocks(size_type n) noexcept
     {
-        grow(size()+count);
-        // TODO Réfléchir, le memcpy ne marche
+        // Whole blocks only : word i goes to word i + q along gcd(count, q) cycles, one scratch word each
+        Block* const data = blocks();
+        const size_type count = num_blocks();
+        const size_type q = n / bits_per_block, offset = n % bits_per_block;
+        if(q != 0)
+        {
+            for(size_type cycle = 0, cycles = std::gcd(count, q); cycle < cycles; ++cycle)
+            {
+                const Block carry = data[cycle];
+                size_type i = cycle;
+                for(size_type source = (i + count - q) % count; source != cycle; source = (i + count - q) % count)
+                {
+                    data[i] = data[source];
+                    i = source;
+                }
+                data[i] = carry;
+            }
+        }
+        // Then the remaining offset, as one funnel shift pass from the top wrapping into word 0
+        if(offset != 0)
+        {
+            const Block top = data[count - 1];
+            for(size_type i = count - 1; i > 0; --i)
+                data[i] = Block(order::shift_up(data[i], offset) | order::shift_down(data[i - 1], bits_per_block - offset));
+            data[0] = Block(order::shift_up(data[0], offset) | order::shift_down(top, bits_per_block - offset));
+        }
     }
 
 
-    template<typename Allocator>
-    typename DynamicBitset<Allocator>::internal_pointer
-    operator+(typename DynamicBitset<Allocator>::internal_pointer::difference_type lhs,
-              typename DynamicBitset<Allocator>::internal_pointer rhs)
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::internal_pointer
+    operator+(typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::internal_pointer::difference_type lhs,
+              typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::internal_pointer rhs)
     {
         return rhs + lhs;
     }
 
-    template<typename Allocator>
-    DynamicBitset<Allocator>::reference::reference(std::byte* ptr, uint8_t off) noexcept :
-        byte{ptr}, offset{off} {}
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::reference::reference(Block* ptr, uint8_t off) noexcept :
+        block{ptr}, offset{off} {}
 
-    template<typename Allocator>
-    typename DynamicBitset<Allocator>::reference& DynamicBitset<Allocator>::reference::operator=(bool b) noexcept
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::reference& DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::reference::operator=(bool b) noexcept
     {
         if(b)
-            *byte |= (std::byte(1) << 7 - offset);
+            *block |= bit_mask(offset);
         else
-            *byte &= ~(std::byte(1) << 7 - offset);
+            *block &= Block(~bit_mask(offset));
         return *this;
     }
 
-    template<typename Allocator>
-    typename DynamicBitset<Allocator>::reference&
-    DynamicBitset<Allocator>::reference::operator=(reference const& other) noexcept
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::reference&
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::reference::operator=(reference const& other) noexcept
     {
         return *this = static_cast<bool>(other);
     }
 
-    template<typename Allocator>
-    void DynamicBitset<Allocator>::reference::flip() noexcept
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::reference::flip() noexcept
     {
-        *byte ^= (std::byte(1) << 7 - offset);
+        *block ^= bit_mask(offset);
     }
 
-    template<typename Allocator>
-    typename DynamicBitset<Allocator>::template internal_pointer<false> DynamicBitset<Allocator>::reference::operator&()
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::template internal_pointer<false> DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::reference::operator&()
     {
-        return internal_pointer(byte, offset);
+        return internal_pointer<false>(block, offset);
     }
 
-    template<typename Allocator>
-    DynamicBitset<Allocator>::reference::operator bool() const noexcept
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::reference::operator bool() const noexcept
     {
-        return std::to_integer<bool>(*byte & (std::byte(1) << 7 - offset));
+        return (*block & bit_mask(offset)) != 0;
     }
 
-    template<typename Allocator>
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
     template<bool is_const>
-    DynamicBitset<Allocator>::internal_pointer<is_const>::internal_pointer(std::byte* ptr, uint8_t off) noexcept :
-        byte{ptr}, offset{off} {}
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::internal_pointer<is_const>::internal_pointer(Block* ptr, uint8_t off) noexcept :
+        block{ptr}, offset{off} {}
 
-    template<typename Allocator>
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
     template<bool is_const>
-    typename DynamicBitset<Allocator>::template internal_pointer<is_const>::pointer&
-    DynamicBitset<Allocator>::internal_pointer<is_const>::operator
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::template internal_pointer<is_const>::pointer&
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::internal_pointer<is_const>::operator
     +=(difference_type d)
     {
         if(d < 0)
             return *this -= -d;
-        byte += d / 8;
-        if(offset + d % 8 > 7)
+        block += d / bits_per_block;
+        if(offset + d % bits_per_block > bits_per_block - 1)
         {
-            ++byte;
-            offset += d % 8 - 8;
+            ++block;
+            offset += d % bits_per_block - bits_per_block;
         }
         else
-            offset += d % 8;
+            offset += d % bits_per_block;
         return *this;
     }
 
-    template<typename Allocator>
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
     template<bool is_const>
-    typename DynamicBitset<Allocator>::template internal_pointer<is_const>::pointer&
-    DynamicBitset<Allocator>::internal_pointer<is_const>::operator
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::template internal_pointer<is_const>::pointer&
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::internal_pointer<is_const>::operator
     -=(difference_type d)
     {
         if(d < 0)
             return *this += -d;
-        byte -= d / 8;
-        if(static_cast<ptrdiff_t>(offset) - d % 8 < 0)
+        block -= d / bits_per_block;
+        if(static_cast<ptrdiff_t>(offset) - static_cast<ptrdiff_t>(d % bits_per_block) < 0)
         {
-            --byte;
-            offset -= d % 8 - 8;
+            --block;
+            offset += bits_per_block - d % bits_per_block;
         }
         else
-            offset -= d % 8;
+            offset -= d % bits_per_block;
         return *this;
     }
 
-    template<typename Allocator>
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
     template<bool is_const>
-    typename DynamicBitset<Allocator>::template internal_pointer<is_const>::pointer
-    DynamicBitset<Allocator>::internal_pointer<is_const>::operator+(
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::template internal_pointer<is_const>::pointer
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::internal_pointer<is_const>::operator+(
         difference_type d) const
     {
-        if(d < 0)
-            return *this - -d;
-        auto temp = byte + d / 8;
-        if(offset + d % 8 > 7)
-            return internal_pointer(temp + 1, offset + d % 8 - 8);
-        return internal_pointer(temp, offset + d % 8);
+        auto temp = *this;
+        return temp += d;
     }
 
-    template<typename Allocator>
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
     template<bool is_const>
-    typename DynamicBitset<Allocator>::template internal_pointer<is_const>::pointer
-    DynamicBitset<Allocator>::internal_pointer<is_const>::operator-(
+    typename DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::template internal_pointer<is_const>::pointer
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::internal_pointer<is_const>::operator-(
         difference_type d) const
     {
-        if(d < 0)
-            return *this + -d;
-        auto temp = byte - d / 8;
-        if(static_cast<ptrdiff_t>(offset) - d % 8 < 0)
-            return internal_pointer(temp - 1, offset - d % 8 + 8);
-        return internal_pointer(temp, offset - d % 8);
+        auto temp = *this;
+        return temp -= d;
     }
 
-    template<typename Allocator>
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
     template<bool is_const>
-    DynamicBitset<Allocator>::internal_pointer<is_const>::internal_pointer(
+    DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>::internal_pointer<is_const>::internal_pointer(
         DynamicBitset::internal_pointer<false> const& other) :
-        byte{other.byte}, offset{other.offset} {}
+        block{other.block}, offset{other.offset} {}
 
     // Non member operators
 
-    template<typename Allocator>
-    bool operator==(DynamicBitset<Allocator> const& lhs, DynamicBitset<Allocator> const& rhs)
+    // The padding is zero, so equal bitsets have equal blocks
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    bool operator==(DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy> const& lhs, DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy> const& rhs) noexcept
     {
-        return (lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin()));
+        const auto l = detail::bit_operand<DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>>::make(lhs), r = detail::bit_operand<DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>>::make(rhs);
+        return l.size() == r.size() && std::memcmp(l.words(), r.words(), l.min_blocks() * sizeof(Block)) == 0;
     }
 
-    template<typename Allocator>
-    bool operator!=(DynamicBitset<Allocator> const& lhs, DynamicBitset<Allocator> const& rhs)
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    bool operator!=(DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy> const& lhs, DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy> const& rhs) noexcept
     {
         return !(lhs == rhs);
     }
 
-    template<typename Allocator>
-    bool operator<(DynamicBitset<Allocator> const& lhs, DynamicBitset<Allocator> const& rhs)
+    // Bitsets order lexicographically, as the sequences of their bits from bit 0
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    bool operator<(DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy> const& lhs, DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy> const& rhs) noexcept
     {
-        return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+        return detail::compare(detail::bit_operand<DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>>::make(lhs), detail::bit_operand<DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>>::make(rhs)) < 0;
     }
 
-    template<typename Allocator>
-    bool operator<=(DynamicBitset<Allocator> const& lhs, DynamicBitset<Allocator> const& rhs)
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    bool operator<=(DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy> const& lhs, DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy> const& rhs) noexcept
     {
-        return !(lhs < rhs);
+        return !(rhs < lhs);
     }
 
-    template<typename Allocator>
-    bool operator>(DynamicBitset<Allocator> const& lhs, DynamicBitset<Allocator> const& rhs)
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    bool operator>(DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy> const& lhs, DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy> const& rhs) noexcept
     {
-        return rhs > lhs;
+        return rhs < lhs;
     }
 
-    template<typename Allocator>
-    bool operator>=(DynamicBitset<Allocator> const& lhs, DynamicBitset<Allocator> const& rhs)
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    bool operator>=(DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy> const& lhs, DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy> const& rhs) noexcept
     {
         return !(lhs < rhs);
     }
 
-    template<typename Allocator>
-    void swap(DynamicBitset<Allocator>& lhs, DynamicBitset<Allocator>& rhs) noexcept;
+#ifdef __cpp_lib_three_way_comparison
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    std::strong_ordering operator<=>(DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy> const& lhs, DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy> const& rhs) noexcept
+    {
+        return detail::compare(detail::bit_operand<DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>>::make(lhs), detail::bit_operand<DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>>::make(rhs)) <=> 0;
+    }
+#endif
+
+    // Lazy bitwise operators, on bitsets and on expressions of bitsets
+
+    template<typename E, typename = std::enable_if_t<detail::is_bit_operand_v<E>>>
+    auto operator<<(E const& e, size_t n) noexcept
+    {
+        return detail::bit_shift<typename detail::bit_operand<E>::type, true>(detail::bit_operand<E>::make(e), n);
+    }
+
+    template<typename E, typename = std::enable_if_t<detail::is_bit_operand_v<E>>>
+    auto operator>>(E const& e, size_t n) noexcept
+    {
+        return detail::bit_shift<typename detail::bit_operand<E>::type, false>(detail::bit_operand<E>::make(e), n);
+    }
+
+    template<typename L, typename R, typename = std::enable_if_t<detail::is_bit_operand_v<L> && detail::is_bit_operand_v<R>>>
+    auto operator&(L const& lhs, R const& rhs) noexcept
+    {
+        return detail::bit_binary<detail::simd::and_op, typename detail::bit_operand<L>::type, typename detail::bit_operand<R>::type>(
+            detail::bit_operand<L>::make(lhs), detail::bit_operand<R>::make(rhs));
+    }
+
+    template<typename L, typename R, typename = std::enable_if_t<detail::is_bit_operand_v<L> && detail::is_bit_operand_v<R>>>
+    auto operator|(L const& lhs, R const& rhs) noexcept
+    {
+        return detail::bit_binary<detail::simd::or_op, typename detail::bit_operand<L>::type, typename detail::bit_operand<R>::type>(
+            detail::bit_operand<L>::make(lhs), detail::bit_operand<R>::make(rhs));
+    }
+
+    template<typename L, typename R, typename = std::enable_if_t<detail::is_bit_operand_v<L> && detail::is_bit_operand_v<R>>>
+    auto operator^(L const& lhs, R const& rhs) noexcept
+    {
+        return detail::bit_binary<detail::simd::xor_op, typename detail::bit_operand<L>::type, typename detail::bit_operand<R>::type>(
+            detail::bit_operand<L>::make(lhs), detail::bit_operand<R>::make(rhs));
+    }
+
+    // Set difference
+    template<typename L, typename R, typename = std::enable_if_t<detail::is_bit_operand_v<L> && detail::is_bit_operand_v<R>>>
+    auto operator-(L const& lhs, R const& rhs) noexcept
+    {
+        return detail::bit_binary<detail::simd::and_not_op, typename detail::bit_operand<L>::type, typename detail::bit_operand<R>::type>(
+            detail::bit_operand<L>::make(lhs), detail::bit_operand<R>::make(rhs));
+    }
+
+    template<typename E, typename = std::enable_if_t<detail::is_bit_operand_v<E>>>
+    auto operator~(E const& e) noexcept
+    {
+        return detail::bit_not<typename detail::bit_operand<E>::type>(detail::bit_operand<E>::make(e));
+    }
+
+    // dst = f(a, b, c) in one pass, bit (a << 2 | b << 1 | c) of table giving f for those inputs
+    // (see truth_table). dst takes the size of a, b and c are zero-extended or truncated to it.
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void apply3(DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>& dst, DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy> const& a, DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy> const& b, DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy> const& c, uint8_t table)
+    {
+        dst.assign_ternary(a, b, c, table);
+    }
+
+    // Cardinalities of bitwise results, computed in one pass without storing the result.
+    // Operands of different sizes are zero-extended.
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    size_t intersection_count(DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy> const& a, DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy> const& b) noexcept
+    {
+        using operand = detail::bit_operand<DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>>;
+        return detail::popcount_binary_op<detail::simd::and_op>(operand::make(a), operand::make(b));
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    size_t union_count(DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy> const& a, DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy> const& b) noexcept
+    {
+        using operand = detail::bit_operand<DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>>;
+        return detail::popcount_binary_op<detail::simd::or_op>(operand::make(a), operand::make(b));
+    }
+
+    // Bits of a not in b
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    size_t difference_count(DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy> const& a, DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy> const& b) noexcept
+    {
+        using operand = detail::bit_operand<DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>>;
+        return detail::popcount_binary_op<detail::simd::and_not_op>(operand::make(a), operand::make(b));
+    }
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    size_t symmetric_difference_count(DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy> const& a, DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy> const& b) noexcept
+    {
+        using operand = detail::bit_operand<DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>>;
+        return detail::popcount_binary_op<detail::simd::xor_op>(operand::make(a), operand::make(b));
+    }
+
+    // |a & b| / |a | b|, 1 when both are empty
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    double jaccard(DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy> const& a, DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy> const& b) noexcept
+    {
+        using operand = detail::bit_operand<DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>>;
+        const auto [intersection, union_] = detail::popcount_binary<detail::simd::and_op, detail::simd::or_op>(operand::make(a), operand::make(b));
+        return union_ == 0 ? 1.0 : double(intersection) / double(union_);
+    }
+
+    // Hash of a bitset kept up to date as the bitset is modified through it, so that hashing it again
+    // costs nothing. It is the XOR of a mix of each 8-byte chunk of the blocks with its index, salted
+    // with the size : a change only rehashes its chunk, and value() equals std::hash of the bitset.
+    template<typename Bitset>
+    class incremental_hash
+    {
+    public:
+        using size_type = typename Bitset::size_type;
+
+        explicit incremental_hash(Bitset& bitset) noexcept : bits{&bitset}, chunks{hash_chunks(bitset)} {}
+
+        static size_t of(Bitset const& bitset) noexcept { return detail::hash_finish(hash_chunks(bitset), bitset.size()); }
+        size_t value() const noexcept { return detail::hash_finish(chunks, bits->size()); }
+        Bitset const& bitset() const noexcept { return *bits; }
+
+        void set(size_type pos, bool value = true)
+        {
+            if(std::as_const(*bits)[pos] != value)
+                flip(pos);
+        }
+        void reset(size_type pos) { set(pos, false); }
+        void flip(size_type pos) { update(pos, [&]{ (*bits)[pos].flip(); }); }
+        void push_back(bool value) { update(bits->size(), [&]{ bits->push_back(value); }); }
+        void pop_back() { update(bits->size() - 1, [&]{ bits->pop_back(); }); }
+
+    private:
+        using leaf_type = typename detail::bit_operand<Bitset>::type;
+        using block_type = typename leaf_type::block_type;
+
+        static uint64_t hash_chunks(Bitset const& bitset) noexcept
+        {
+            const leaf_type leaf = detail::bit_operand<Bitset>::make(bitset);
+            return detail::hash_chunks(reinterpret_cast<std::byte const*>(leaf.words()), leaf.min_blocks() * sizeof(block_type));
+        }
+
+        // Swaps the mix of the chunk holding bit pos for its mix after the change
+        template<typename Change>
+        void update(size_type pos, Change change)
+        {
+            const size_t j = pos / (sizeof(block_type) * CHAR_BIT) * sizeof(block_type) / 8;
+            chunks ^= hash_chunk(j);
+            change();
+            chunks ^= hash_chunk(j);
+        }
+
+        uint64_t hash_chunk(size_t j) const noexcept
+        {
+            const leaf_type leaf = detail::bit_operand<Bitset>::make(*bits);
+            return detail::hash_chunk(reinterpret_cast<std::byte const*>(leaf.words()), leaf.min_blocks() * sizeof(block_type), j);
+        }
+
+        Bitset* bits;
+        uint64_t chunks;
+    };
+
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    void swap(DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>& lhs, DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>& rhs) noexcept
+    {
+        lhs.swap(rhs);
+    }
+
+    namespace pmr
+    {
+        // DynamicBitset allocating from a std::pmr::memory_resource. As for std::pmr containers,
+        // copies use the default resource unless given an allocator, and the resource never propagates.
+        template<typename Block = uint64_t, size_t Alignment = alignof(Block), typename BitOrder = lsb_first, bool CopyOnWrite = false, typename GrowthPolicy = geometric_growth<>>
+        using DynamicBitset = ok::DynamicBitset<std::pmr::polymorphic_allocator<std::byte>, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>;
+    };
+
+};
 
+namespace std
+{
+    // Hashes the blocks word by word, the zero padding standing for a masked tail. The same function
+    // as ok::incremental_hash, so that both can hash the keys of one container.
+    template<typename Allocator, typename Block, size_t Alignment, typename BitOrder, bool CopyOnWrite, typename GrowthPolicy>
+    struct hash<ok::DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>>
+    {
+        size_t operator()(ok::DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy> const& b) const noexcept
+        {
+            return ok::incremental_hash<ok::DynamicBitset<Allocator, Block, Alignment, BitOrder, CopyOnWrite, GrowthPolicy>>::of(b);
+        }
+    };
 };
 #endif // DYNAMICBITSET_HPP
@@ -0,0 +1,659 @@
+#ifndef SEGMENTEDBITSET_HPP
+#define SEGMENTEDBITSET_HPP
+
+#include "DynamicBitset.hpp"
+
+#include <vector>
+
+
+namespace ok
+{
+
+    // Bitset stored in fixed-size chunks reached through a chunk table. Growing only allocates
+    // new chunks : existing bits are never copied, and references to them stay valid.
+    template<typename Allocator = std::allocator<std::byte>, typename Block = uint64_t, size_t ChunkBits = (size_t(1) << 20), typename BitOrder = lsb_first>
+    class SegmentedBitset : private Allocator
+    {
+        using flat_type = DynamicBitset<Allocator, Block, alignof(Block), BitOrder>;
+
+        static_assert(ChunkBits % flat_type::bits_per_block == 0 && (ChunkBits & (ChunkBits - 1)) == 0,
+                      "ChunkBits must be a power of two no smaller than the block size");
+
+        template<bool is_const>
+        struct internal_pointer;
+    public:
+        using value_type = bool;
+        using allocator_type = Allocator;
+        using block_type = Block;
+        using bit_order = BitOrder;
+        using size_type = typename flat_type::size_type;
+        using difference_type = std::ptrdiff_t;
+        using reference = typename flat_type::reference;
+        using const_reference = bool;
+
+        static constexpr size_type bits_per_block = flat_type::bits_per_block;
+        static constexpr size_type bits_per_chunk = ChunkBits;
+        static constexpr size_type blocks_per_chunk = ChunkBits / bits_per_block;
+        static constexpr size_type npos = flat_type::npos;
+
+    private:
+        // Iterators hold the bitset and a position, so that they survive growth like references do
+        template<bool is_const>
+        struct internal_pointer
+        {
+            friend SegmentedBitset;
+
+            using container = std::conditional_t<is_const, SegmentedBitset const, SegmentedBitset>;
+
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = bool;
+            using reference = std::conditional_t<is_const, bool, typename SegmentedBitset::reference>;
+            using const_reference = bool;
+            using pointer = internal_pointer;
+            using difference_type = typename SegmentedBitset::difference_type;
+            using size_type = typename SegmentedBitset::size_type;
+
+            internal_pointer() = default;
+
+            internal_pointer(container* owner, size_type pos) noexcept : owner{owner}, pos{pos} {}
+
+            internal_pointer(internal_pointer<false> const& other) noexcept : owner{other.owner}, pos{other.pos} {}
+
+            internal_pointer& operator++() noexcept { ++pos; return *this; }
+            internal_pointer operator++(int) noexcept { auto temp = *this; ++pos; return temp; }
+            internal_pointer& operator--() noexcept { --pos; return *this; }
+            internal_pointer operator--(int) noexcept { auto temp = *this; --pos; return temp; }
+
+            internal_pointer& operator+=(difference_type d) noexcept { pos += d; return *this; }
+            internal_pointer& operator-=(difference_type d) noexcept { pos -= d; return *this; }
+            internal_pointer operator+(difference_type d) const noexcept { return internal_pointer(owner, pos + d); }
+            internal_pointer operator-(difference_type d) const noexcept { return internal_pointer(owner, pos - d); }
+            friend internal_pointer operator+(difference_type d, internal_pointer it) noexcept { return it + d; }
+
+            reference operator*() const { return (*owner)[pos]; }
+
+            reference operator[](difference_type d) const { return (*owner)[pos + d]; }
+
+            bool operator==(internal_pointer<true> const& other) const noexcept { return pos == other.pos; }
+            bool operator!=(internal_pointer<true> const& other) const noexcept { return pos != other.pos; }
+            bool operator<(internal_pointer<true> const& other) const noexcept { return pos < other.pos; }
+            bool operator>(internal_pointer<true> const& other) const noexcept { return pos > other.pos; }
+            bool operator<=(internal_pointer<true> const& other) const noexcept { return pos <= other.pos; }
+            bool operator>=(internal_pointer<true> const& other) const noexcept { return pos >= other.pos; }
+
+            difference_type operator-(internal_pointer<true> const& other) const noexcept
+            {
+                return difference_type(pos) - difference_type(other.pos);
+            }
+
+        private:
+            friend struct internal_pointer<!is_const>;
+
+            container* owner = nullptr;
+            size_type pos = 0;
+        };
+
+    public:
+        using iterator = internal_pointer<false>;
+        using const_iterator = internal_pointer<true>;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        // Constructors
+        SegmentedBitset() noexcept(std::is_nothrow_default_constructible_v<Allocator>);
+        explicit SegmentedBitset(Allocator const& alloc);
+        explicit SegmentedBitset(size_type count, bool value = false, Allocator const& alloc = Allocator());
+        template<typename Iter, typename = std::enable_if_t<detail::is_input_iterator_v<Iter>>>
+        SegmentedBitset(Iter first, Iter last, Allocator const& alloc = Allocator());
+        SegmentedBitset(std::initializer_list<bool> ilist, Allocator const& alloc = Allocator());
+        SegmentedBitset(SegmentedBitset const& other);
+        SegmentedBitset(SegmentedBitset&& other) noexcept;
+
+        ~SegmentedBitset();
+
+        // Copy and assignment
+        SegmentedBitset& operator=(SegmentedBitset const& other);
+        SegmentedBitset& operator=(SegmentedBitset&& other) noexcept(std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value
+                                                                     || std::allocator_traits<Allocator>::is_always_equal::value);
+
+        // Element access
+        reference at(size_type pos);
+        const_reference at(size_type pos) const;
+
+        reference operator[](size_type pos);
+        bool operator[](size_type pos) const;
+
+        reference front() { return (*this)[0]; }
+        const_reference front() const { return (*this)[0]; }
+
+        reference back() { return (*this)[size() - 1]; }
+        const_reference back() const { return (*this)[size() - 1]; }
+
+        // Iterators
+        iterator begin() noexcept { return iterator(this, 0); }
+        const_iterator begin() const noexcept { return const_iterator(this, 0); }
+        const_iterator cbegin() const noexcept { return begin(); }
+
+        iterator end() noexcept { return iterator(this, size()); }
+        const_iterator end() const noexcept { return const_iterator(this, size()); }
+        const_iterator cend() const noexcept { return end(); }
+
+        reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+        const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+        reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+        const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+        // Capacity
+        bool empty() const noexcept { return d.size == 0; }
+
+        size_type size() const noexcept { return d.size; }
+        size_type max_size() const noexcept;
+
+        void reserve(size_type new_cap);
+
+        void shrink_to_fit() noexcept;
+
+        size_type capacity() const noexcept { return d.chunks.size() * bits_per_chunk; }
+
+        // Modifiers
+        void clear() noexcept;
+
+        void push_back(bool value);
+
+        void pop_back();
+
+        void resize(size_type count, bool value = false);
+
+        void swap(SegmentedBitset& other) noexcept;
+
+        void flip();
+
+        // Bitwise operations : the word kernels of DynamicBitset run once per chunk
+        SegmentedBitset& operator&=(SegmentedBitset const& b);
+        SegmentedBitset& operator|=(SegmentedBitset const& b);
+        SegmentedBitset& operator^=(SegmentedBitset const& b);
+
+        // Member functions
+        allocator_type get_allocator() const { return *alloc(); }
+
+        bool any() const;
+
+        bool none() const { return !any(); }
+
+        size_type popcount() const;
+
+        // Index of the first set bit at or after 0 / after pos, npos when there is none
+        size_type find_first() const noexcept;
+        size_type find_next(size_type pos) const noexcept;
+
+        // Block and chunk access
+        size_type num_blocks() const noexcept { return ceil_div<bits_per_block>(size()); }
+        Block block(size_type i) const noexcept { return chunk_blocks(i / blocks_per_chunk)[i % blocks_per_chunk]; }
+
+        size_type num_chunks() const noexcept { return ceil_div<bits_per_chunk>(size()); }
+        Block const* chunk_blocks(size_type i) const noexcept { return d.chunks[i]; }
+
+    private:
+        using block_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Block>;
+        using block_traits = std::allocator_traits<block_allocator>;
+        using table_type = std::vector<Block*, typename std::allocator_traits<Allocator>::template rebind_alloc<Block*>>;
+
+        using order = detail::bit_order<BitOrder, Block>;
+
+        Block* allocate_chunk();
+        void deallocate_chunk(Block* chunk) noexcept;
+        void add_chunks(size_type count);
+        void release_chunks(size_type keep) noexcept;
+
+        template<typename Op>
+        SegmentedBitset& apply_binary(SegmentedBitset const& b);
+        size_type find_from(size_type pos) const noexcept;
+
+        // Number of blocks of chunk i holding bits of the bitset
+        size_type used_blocks(size_type i) const noexcept { return std::min(blocks_per_chunk, num_blocks() - i * blocks_per_chunk); }
+
+        // Same padding invariant as DynamicBitset : every bit past size() in the last block in use is
+        // zero, blocks past it are garbage and get cleared when the size grows over them.
+        void resize_padded(size_type size) noexcept;
+        void fill_bits(size_type pos, size_type n, bool value) noexcept;
+
+        void check_length(size_type size) const;
+        allocator_type* alloc() noexcept { return static_cast<allocator_type*>(this); }
+        allocator_type const* alloc() const noexcept { return static_cast<allocator_type const*>(this); }
+
+    private:
+        struct data
+        {
+            explicit data(Allocator const& alloc) : chunks(alloc) {}
+
+            table_type chunks;
+            size_type size = 0;
+        };
+        data d;
+    };
+
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::SegmentedBitset() noexcept(std::is_nothrow_default_constructible_v<Allocator>)
+        : SegmentedBitset(Allocator())
+    {}
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::SegmentedBitset(Allocator const& alloc)
+        : Allocator(alloc),
+          d(alloc)
+    {}
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::SegmentedBitset(size_type count, bool value, Allocator const& alloc)
+        : SegmentedBitset(alloc)
+    {
+        resize(count, value);
+    }
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    template<typename Iter, typename>
+    SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::SegmentedBitset(Iter first, Iter last, Allocator const& alloc)
+        : SegmentedBitset(alloc)
+    {
+        if constexpr(detail::is_forward_iterator_v<Iter>)
+            reserve(std::distance(first, last));
+        for(; first != last; ++first)
+            push_back(*first);
+    }
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::SegmentedBitset(std::initializer_list<bool> ilist, Allocator const& alloc)
+        : SegmentedBitset(ilist.begin(), ilist.end(), alloc)
+    {}
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::SegmentedBitset(SegmentedBitset const& other)
+        : SegmentedBitset(std::allocator_traits<Allocator>::select_on_container_copy_construction(*other.alloc()))
+    {
+        *this = other;
+    }
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::SegmentedBitset(SegmentedBitset&& other) noexcept
+        : Allocator(std::move(*other.alloc())),
+          d(std::move(other.d))
+    {
+        other.d.chunks.clear();
+        other.d.size = 0;
+    }
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::~SegmentedBitset()
+    {
+        release_chunks(0);
+    }
+
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>& SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::operator=(SegmentedBitset const& other)
+    {
+        if(this == &other)
+            return *this;
+
+        if constexpr(std::allocator_traits<Allocator>::propagate_on_container_copy_assignment::value)
+        {
+            if(*alloc() != *other.alloc())
+            {
+                release_chunks(0);
+                d.chunks = table_type(*other.alloc());
+            }
+            *alloc() = *other.alloc();
+        }
+
+        // Reuses the chunks already owned, only the blocks in use are copied
+        d.size = 0;
+        reserve(other.size());
+        for(size_type i = 0; i < other.num_chunks(); ++i)
+            std::copy_n(other.d.chunks[i], other.used_blocks(i), d.chunks[i]);
+        d.size = other.size();
+        return *this;
+    }
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>& SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::operator=(SegmentedBitset&& other) noexcept(std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value
+                                                                                                                                                          || std::allocator_traits<Allocator>::is_always_equal::value)
+    {
+        if(this == &other)
+            return *this;
+
+        if constexpr(std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value)
+            *alloc() = std::move(*other.alloc());
+        else if(*alloc() != *other.alloc())
+            return *this = other; // The chunks of other can not be freed by our allocator
+
+        release_chunks(0);
+        d.chunks = std::move(other.d.chunks);
+        d.size = std::exchange(other.d.size, 0);
+        other.d.chunks.clear();
+        return *this;
+    }
+
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    typename SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::reference SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::at(size_type pos)
+    {
+        if(pos >= size())
+            throw std::out_of_range("SegmentedBitset : index " + std::to_string(pos) + " is out of range (size is " + std::to_string(size()) + ")");
+        return (*this)[pos];
+    }
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    typename SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::const_reference SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::at(size_type pos) const
+    {
+        if(pos >= size())
+            throw std::out_of_range("SegmentedBitset : index " + std::to_string(pos) + " is out of range (size is " + std::to_string(size()) + ")");
+        return (*this)[pos];
+    }
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    typename SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::reference SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::operator[](size_type pos)
+    {
+        Block* chunk = d.chunks[pos / bits_per_chunk];
+        pos %= bits_per_chunk;
+        return reference(chunk + pos / bits_per_block, uint8_t(pos % bits_per_block));
+    }
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    bool SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::operator[](size_type pos) const
+    {
+        Block const* chunk = d.chunks[pos / bits_per_chunk];
+        pos %= bits_per_chunk;
+        return (chunk[pos / bits_per_block] & order::bit(pos % bits_per_block)) != 0;
+    }
+
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    typename SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::size_type SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::max_size() const noexcept
+    {
+        const size_type chunks = std::min<size_type>(block_traits::max_size(block_allocator(*alloc())) / blocks_per_chunk,
+                                                     std::allocator_traits<typename table_type::allocator_type>::max_size(d.chunks.get_allocator()));
+        return std::min<size_type>(std::numeric_limits<difference_type>::max() / bits_per_chunk, chunks) * bits_per_chunk;
+    }
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    void SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::reserve(size_type new_cap)
+    {
+        if(new_cap > capacity())
+        {
+            check_length(new_cap);
+            add_chunks(ceil_div<bits_per_chunk>(new_cap) - d.chunks.size());
+        }
+    }
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    void SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::shrink_to_fit() noexcept
+    {
+        release_chunks(num_chunks());
+        try { d.chunks.shrink_to_fit(); }
+        catch(...) {}
+    }
+
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    void SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::clear() noexcept
+    {
+        d.size = 0;
+    }
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    void SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::push_back(bool value)
+    {
+        if(size() == capacity())
+        {
+            check_length(size() + 1);
+            add_chunks(1);
+        }
+        resize_padded(size() + 1);
+        if(value)
+            (*this)[size() - 1] = true;
+    }
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    void SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::pop_back()
+    {
+        resize_padded(size() - 1);
+    }
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    void SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::resize(size_type count, bool value)
+    {
+        const size_type old_size = size();
+        if(count > capacity())
+        {
+            check_length(count);
+            // Chunks never move, so extra ones would only cost memory
+            add_chunks(ceil_div<bits_per_chunk>(count) - d.chunks.size());
+        }
+        resize_padded(count);
+        if(value && count > old_size)
+            fill_bits(old_size, count - old_size, true);
+    }
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    void SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::swap(SegmentedBitset& other) noexcept
+    {
+        if constexpr(std::allocator_traits<Allocator>::propagate_on_container_swap::value)
+        {
+            using std::swap;
+            swap(*alloc(), *other.alloc());
+        }
+        d.chunks.swap(other.d.chunks);
+        std::swap(d.size, other.d.size);
+    }
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    void SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::flip()
+    {
+        for(size_type i = 0; i < num_chunks(); ++i)
+        {
+            Block* const chunk = d.chunks[i];
+            std::transform(chunk, chunk + used_blocks(i), chunk, [](Block b) { return Block(~b); });
+        }
+        if(size() % bits_per_block != 0)
+        {
+            Block& last = d.chunks[num_chunks() - 1][(num_blocks() - 1) % blocks_per_chunk];
+            last &= order::head(size() % bits_per_block);
+        }
+    }
+
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>& SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::operator&=(SegmentedBitset const& b)
+    {
+        return apply_binary<detail::simd::and_op>(b);
+    }
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>& SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::operator|=(SegmentedBitset const& b)
+    {
+        return apply_binary<detail::simd::or_op>(b);
+    }
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>& SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::operator^=(SegmentedBitset const& b)
+    {
+        return apply_binary<detail::simd::xor_op>(b);
+    }
+
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    bool SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::any() const
+    {
+        for(size_type i = 0; i < num_chunks(); ++i)
+            if(std::any_of(d.chunks[i], d.chunks[i] + used_blocks(i), [](Block b) { return b != 0; }))
+                return true;
+        return false;
+    }
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    typename SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::size_type SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::popcount() const
+    {
+        size_type sum = 0;
+        for(size_type i = 0; i < num_chunks(); ++i)
+            sum += detail::popcount(d.chunks[i], d.chunks[i] + used_blocks(i));
+        return sum;
+    }
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    typename SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::size_type SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::find_first() const noexcept
+    {
+        return find_from(0);
+    }
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    typename SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::size_type SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::find_next(size_type pos) const noexcept
+    {
+        return pos >= size() ? npos : find_from(pos + 1);
+    }
+
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    Block* SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::allocate_chunk()
+    {
+        block_allocator a(*alloc());
+        return block_traits::allocate(a, blocks_per_chunk);
+    }
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    void SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::deallocate_chunk(Block* chunk) noexcept
+    {
+        block_allocator a(*alloc());
+        block_traits::deallocate(a, chunk, blocks_per_chunk);
+    }
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    void SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::add_chunks(size_type count)
+    {
+        // Only the table may move : it grows geometrically, as it holds one pointer per chunk, and
+        // reserving first keeps push_back from throwing with a chunk in hand
+        if(d.chunks.size() + count > d.chunks.capacity())
+            d.chunks.reserve(std::max(d.chunks.size() + count, 2 * d.chunks.capacity()));
+        for(; count > 0; --count)
+            d.chunks.push_back(allocate_chunk());
+    }
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    void SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::release_chunks(size_type keep) noexcept
+    {
+        for(size_type i = keep; i < d.chunks.size(); ++i)
+            deallocate_chunk(d.chunks[i]);
+        if(keep < d.chunks.size())
+            d.chunks.erase(d.chunks.begin() + keep, d.chunks.end());
+    }
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    template<typename Op>
+    SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>& SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::apply_binary(SegmentedBitset const& b)
+    {
+        // Same semantics as DynamicBitset : the size is kept, and b is read as zeros past its end
+        constexpr bool keeps_tail = Op::scalar(Block(~Block(0)), Block(0)) == Block(~Block(0)) && Op::scalar(Block(0), Block(0)) == Block(0);
+        for(size_type i = 0; i < num_chunks(); ++i)
+        {
+            Block* const chunk = d.chunks[i];
+            if(i < b.num_chunks())
+            {
+                const size_type common = std::min(used_blocks(i), b.used_blocks(i));
+                detail::simd::binary<Op>(reinterpret_cast<std::byte*>(chunk), reinterpret_cast<std::byte const*>(b.d.chunks[i]), common * sizeof(Block));
+                if constexpr(!keeps_tail)
+                    std::transform(chunk + common, chunk + used_blocks(i), chunk + common, [](Block block) { return Op::scalar(block, Block(0)); });
+            }
+            else if constexpr(!keeps_tail)
+                std::transform(chunk, chunk + used_blocks(i), chunk, [](Block block) { return Op::scalar(block, Block(0)); });
+        }
+        // b may be longer than size() inside the last block
+        resize_padded(size());
+        return *this;
+    }
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    typename SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::size_type SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::find_from(size_type pos) const noexcept
+    {
+        // Each chunk is searched like a DynamicBitset : the skipping kernel jumps over zero blocks
+        for(size_type c = pos / bits_per_chunk; pos < size(); pos = ++c * bits_per_chunk)
+        {
+            Block const* const chunk = d.chunks[c];
+            const size_type count = used_blocks(c);
+            size_type i = pos % bits_per_chunk / bits_per_block;
+            Block word = Block(chunk[i] & ~order::head(pos % bits_per_block));
+            if(word == 0)
+            {
+                ++i;
+                i += detail::simd::skip<0x00>(reinterpret_cast<std::byte const*>(chunk + i), (count - i) * sizeof(Block)) / sizeof(Block);
+                while(i < count && chunk[i] == 0)
+                    ++i;
+                if(i == count)
+                    continue;
+                word = chunk[i];
+            }
+            return c * bits_per_chunk + i * bits_per_block + order::first(word);
+        }
+        return npos;
+    }
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    void SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::resize_padded(size_type size) noexcept
+    {
+        const size_type old_blocks = num_blocks();
+        d.size = size;
+        const size_type new_blocks = num_blocks();
+
+        if(new_blocks > old_blocks)
+        {
+            for(size_type i = old_blocks; i < new_blocks;)
+            {
+                Block* const chunk = d.chunks[i / blocks_per_chunk];
+                const size_type last = std::min(new_blocks, (i / blocks_per_chunk + 1) * blocks_per_chunk);
+                std::fill(chunk + i % blocks_per_chunk, chunk + (last - 1) % blocks_per_chunk + 1, Block(0));
+                i = last;
+            }
+        }
+        else if(size % bits_per_block != 0)
+        {
+            Block& last = d.chunks[(new_blocks - 1) / blocks_per_chunk][(new_blocks - 1) % blocks_per_chunk];
+            last &= order::head(size % bits_per_block);
+        }
+    }
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    void SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::fill_bits(size_type pos, size_type n, bool value) noexcept
+    {
+        // The block kernel runs once per chunk touched
+        while(n > 0)
+        {
+            const size_type offset = pos % bits_per_chunk;
+            const size_type count = std::min(n, bits_per_chunk - offset);
+            detail::fill_bits<BitOrder>(d.chunks[pos / bits_per_chunk], offset, count, value);
+            pos += count;
+            n -= count;
+        }
+    }
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    void SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>::check_length(size_type size) const
+    {
+        if(size > max_size())
+            throw std::length_error("SegmentedBitset : requested size " + std::to_string(size) + " exceeds max_size()");
+    }
+
+
+    template<typename Allocator, typename Block, size_t ChunkBits, typename BitOrder>
+    void swap(SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>& lhs, SegmentedBitset<Allocator, Block, ChunkBits, BitOrder>& rhs) noexcept
+    {
+        lhs.swap(rhs);
+    }
+
+    namespace pmr
+    {
+        template<typename Block = uint64_t, size_t ChunkBits = (size_t(1) << 20), typename BitOrder = lsb_first>
+        using SegmentedBitset = ok::SegmentedBitset<std::pmr::polymorphic_allocator<std::byte>, Block, ChunkBits, BitOrder>;
+    }
+
+}
+
+#endif //SEGMENTEDBITSET_HPP
@@ -1,5 +1,60 @@
 #include "catch.hpp"
 #include "DynamicBitset.hpp"
+#include <bitset>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+template<typename T>
+struct counting_allocator : std::allocator<T>
+{
+    template<typename U>
+    struct rebind { using other = counting_allocator<U>; };
+
+    static inline size_t allocations = 0;
+    static inline uintptr_t last_address = 0;
+
+    counting_allocator() = default;
+    template<typename U>
+    counting_allocator(counting_allocator<U> const&) {}
+
+    T* allocate(size_t n)
+    {
+        ++counting_allocator<std::byte>::allocations;
+        T* p = std::allocator<T>::allocate(n);
+        counting_allocator<std::byte>::last_address = reinterpret_cast<uintptr_t>(p);
+        return p;
+    }
+};
+
+// Hands out dirty memory, except through allocate_zeroed
+template<typename T>
+struct zeroing_allocator : std::allocator<T>
+{
+    template<typename U>
+    struct rebind { using other = zeroing_allocator<U>; };
+
+    static inline size_t zeroed = 0;
+
+    zeroing_allocator() = default;
+    template<typename U>
+    zeroing_allocator(zeroing_allocator<U> const&) {}
+
+    T* allocate(size_t n)
+    {
+        T* p = std::allocator<T>::allocate(n);
+        std::memset(static_cast<void*>(p), 0xA5, n * sizeof(T));
+        return p;
+    }
+
+    T* allocate_zeroed(size_t n)
+    {
+        ++zeroing_allocator<std::byte>::zeroed;
+        T* p = std::allocator<T>::allocate(n);
+        std::memset(static_cast<void*>(p), 0, n * sizeof(T));
+        return p;
+    }
+};
 
 const bool A6[] = {1, 0, 1, 1, 1, 1, 1};
 const bool A126[] = {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
@@ -22,6 +77,18 @@ const bool A47[] = {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
                    0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0,
                    0, 0, 0, 1, 1};
 
+// Pseudo-random reference contents, a different sequence for each seed
+std::vector<bool> pattern(size_t size, uint64_t seed)
+{
+    std::vector<bool> bits(size);
+    for(size_t i = 0; i < size; ++i)
+    {
+        seed = seed * 6364136223846793005 + 1442695040888963407;
+        bits[i] = (seed >> 33) & 1;
+    }
+    return bits;
+}
+
 using namespace ok;
 
 TEST_CASE( "size and resize", "[DynamicBitset]" ) {
@@ -59,4 +126,1137 @@ TEST_CASE("popcnt"){
     REQUIRE(db6.popcount() == 6);
     REQUIRE(db47.popcount() == 47);
     REQUIRE(db126.popcount() == 126);
-}
\ No newline at end of file
+}
+
+TEMPLATE_TEST_CASE("block types", "[DynamicBitset]", uint8_t, uint16_t, uint32_t, uint64_t) {
+    using bitset = DynamicBitset<std::allocator<std::byte>, TestType>;
+
+    bitset v(A126);
+    REQUIRE( v.capacity() % bitset::bits_per_block == 0 );
+    REQUIRE( v.num_blocks() == ceil_div<bitset::bits_per_block>(v.size()) );
+    REQUIRE( v.popcount() == 126 );
+    REQUIRE( std::equal(v.begin(), v.end(), std::begin(A126)) );
+
+    SECTION( "insert and erase move whole blocks" ) {
+        v.insert(v.begin() + 3, 70, true);
+        REQUIRE( v.size() == 307 );
+        REQUIRE( v.popcount() == 196 );
+        REQUIRE( std::equal(v.begin(), v.begin() + 3, std::begin(A126)) );
+        REQUIRE( std::equal(v.begin() + 73, v.end(), std::begin(A126) + 3) );
+
+        v.erase(v.begin() + 3, v.begin() + 73);
+        REQUIRE( std::equal(v.begin(), v.end(), std::begin(A126), std::end(A126)) );
+    }
+    SECTION( "range popcount masks partial blocks" ) {
+        for(size_t first = 0; first < 20; ++first)
+            for(size_t n = 0; first + n <= v.size(); n += 7)
+                REQUIRE( v.popcount(v.cbegin() + first, n) == size_t(std::count(std::begin(A126) + first, std::begin(A126) + first + n, true)) );
+    }
+}
+
+TEST_CASE("inline storage", "[DynamicBitset]") {
+    using bitset = DynamicBitset<counting_allocator<std::byte>>;
+    counting_allocator<std::byte>::allocations = 0;
+
+    bitset v(1);
+    bitset w(A6);
+    REQUIRE( v.capacity() >= 128 );
+    REQUIRE( counting_allocator<std::byte>::allocations == 0 );
+
+    SECTION( "growing past the inline capacity moves to the heap" ) {
+        v.resize(v.capacity(), true);
+        REQUIRE( counting_allocator<std::byte>::allocations == 0 );
+        v.push_back(false);
+        REQUIRE( counting_allocator<std::byte>::allocations == 1 );
+        REQUIRE( v.popcount() == v.size() - 2 );
+
+        v.resize(3);
+        v.shrink_to_fit();
+        REQUIRE( v.size() == 3 );
+        REQUIRE( v.popcount() == 2 );
+        REQUIRE( counting_allocator<std::byte>::allocations == 1 );
+    }
+    SECTION( "moves and swaps carry inline bits" ) {
+        bitset moved(std::move(w));
+        REQUIRE( std::equal(moved.begin(), moved.end(), std::begin(A6), std::end(A6)) );
+        REQUIRE( w.empty() );
+
+        moved.swap(v);
+        REQUIRE( v.size() == 7 );
+        REQUIRE( moved.size() == 1 );
+        REQUIRE( std::equal(v.begin(), v.end(), std::begin(A6), std::end(A6)) );
+        REQUIRE( counting_allocator<std::byte>::allocations == 0 );
+    }
+}
+
+TEMPLATE_TEST_CASE_SIG("aligned storage", "[DynamicBitset]", ((size_t Alignment), Alignment), 32, 64) {
+    using bitset = DynamicBitset<counting_allocator<std::byte>, uint64_t, Alignment>;
+    constexpr size_t vector_bits = Alignment * CHAR_BIT;
+
+    bitset v(A126);
+    v.reserve(1000);
+    REQUIRE( counting_allocator<std::byte>::last_address % Alignment == 0 );
+    REQUIRE( v.capacity() % vector_bits == 0 );
+    REQUIRE( v.popcount() == 126 );
+
+    v.resize(vector_bits + 1, true);
+    v.shrink_to_fit();
+    REQUIRE( v.capacity() == 2 * vector_bits );
+    REQUIRE( counting_allocator<std::byte>::last_address % Alignment == 0 );
+    REQUIRE( v.popcount() == 126 + (vector_bits + 1 - std::size(A126)) );
+}
+
+TEMPLATE_TEST_CASE_SIG("padding stays zero", "[DynamicBitset]", ((size_t Alignment), Alignment), 8, 64) {
+    using bitset = DynamicBitset<std::allocator<std::byte>, uint64_t, Alignment>;
+
+    bitset v(300, true);
+    REQUIRE( v.popcount() == 300 );
+
+    SECTION( "flip does not set padding bits" ) {
+        v.resize(250);
+        v.flip();
+        REQUIRE( v.none() );
+        v.flip();
+        REQUIRE( v.popcount() == 250 );
+    }
+    SECTION( "shrinking then growing exposes zeros" ) {
+        v.resize(70);
+        v.resize(600);
+        REQUIRE( v.popcount() == 70 );
+        v.pop_back();
+        v.erase(v.begin(), v.begin() + 5);
+        v.resize(2000);
+        REQUIRE( v.popcount() == 65 );
+        v.clear();
+        v.resize(1000);
+        REQUIRE( v.none() );
+    }
+    SECTION( "assign and copies keep padding clear" ) {
+        v.assign(130, true);
+        v.resize(190);
+        REQUIRE( v.popcount() == 130 );
+        bitset w(v);
+        w.resize(400);
+        REQUIRE( w.popcount() == 130 );
+    }
+    SECTION( "kernels over padded blocks keep padding clear" ) {
+        bitset w(450);
+        for(size_t i = 0; i < w.size(); i += 3)
+            w[i] = true;
+        bitset x = v;
+        x.xnor(w);
+        size_t expected = 0;
+        for(size_t i = 0; i < x.size(); ++i)
+        {
+            REQUIRE( x[i] == w[i] );
+            expected += x[i];
+        }
+        REQUIRE( x.popcount() == expected );
+        x.resize(1000);
+        REQUIRE( x.popcount() == expected );
+
+        w.nand(v);
+        REQUIRE( w.popcount() == 450 - 100 );
+        apply3(x, w, v, v, truth_table::a ^ truth_table::b);
+        REQUIRE( x.size() == 450 );
+        REQUIRE( x.popcount() == 100 + 150 );
+    }
+}
+
+TEST_CASE("bit order", "[DynamicBitset]") {
+    DynamicBitset<> lsb(A47);
+    DynamicBitset<std::allocator<std::byte>, uint64_t, alignof(uint64_t), msb_first> msb(A47);
+
+    for(size_t i = 0; i < lsb.size(); ++i)
+    {
+        REQUIRE( ((lsb.block(i / 64) >> (i % 64)) & 1) == A47[i] );
+        REQUIRE( ((msb.block(i / 64) >> (63 - i % 64)) & 1) == A47[i] );
+    }
+
+    SECTION( "both orders agree on bit operations" ) {
+        lsb.insert(lsb.begin() + 30, 45, true);
+        msb.insert(msb.begin() + 30, 45, true);
+        lsb.erase(lsb.begin() + 3, lsb.begin() + 12);
+        msb.erase(msb.begin() + 3, msb.begin() + 12);
+        REQUIRE( std::equal(lsb.begin(), lsb.end(), msb.begin(), msb.end()) );
+        REQUIRE( lsb.popcount(lsb.cbegin() + 5, 70) == msb.popcount(msb.cbegin() + 5, 70) );
+    }
+}
+
+TEST_CASE("copy on write", "[DynamicBitset]") {
+    using bitset = DynamicBitset<counting_allocator<std::byte>, uint64_t, alignof(uint64_t), lsb_first, true>;
+
+    bitset v(A126);
+    counting_allocator<std::byte>::allocations = 0;
+
+    bitset w(v);
+    bitset x;
+    x = w;
+    REQUIRE( counting_allocator<std::byte>::allocations == 0 );
+    REQUIRE( std::as_const(x).begin() == std::as_const(v).begin() );
+
+    SECTION( "read only operations share the buffer" ) {
+        REQUIRE( w.popcount() == 126 );
+        REQUIRE( std::as_const(w)[17] );
+        REQUIRE( w == v );
+        REQUIRE( w.any() );
+        REQUIRE( counting_allocator<std::byte>::allocations == 0 );
+    }
+    SECTION( "the first mutation clones" ) {
+        w[0] = false;
+        w.push_back(true);
+        REQUIRE( counting_allocator<std::byte>::allocations == 1 );
+        REQUIRE( w.popcount() == 126 );
+        REQUIRE( v.popcount() == 126 );
+        REQUIRE( v[0] );
+        REQUIRE( std::equal(v.begin(), v.end(), std::begin(A126), std::end(A126)) );
+
+        x.resize(10);
+        REQUIRE( counting_allocator<std::byte>::allocations == 2 );
+        REQUIRE( v.size() == std::size(A126) );
+        REQUIRE( v.popcount() == 126 );
+    }
+    SECTION( "the last owner frees the buffer" ) {
+        v.clear();
+        v.shrink_to_fit();
+        w = bitset();
+        REQUIRE( x.popcount() == 126 );
+        x.flip();
+        REQUIRE( counting_allocator<std::byte>::allocations == 0 );
+        REQUIRE( x.popcount() == std::size(A126) - 126 );
+    }
+}
+
+TEST_CASE("growth policies", "[DynamicBitset]") {
+    DynamicBitset<std::allocator<std::byte>, uint64_t, 8, lsb_first, false, exact_growth> exact(256);
+    DynamicBitset<std::allocator<std::byte>, uint64_t, 8, lsb_first, false, geometric_growth<>> geometric(256);
+    DynamicBitset<std::allocator<std::byte>, uint64_t, 8, lsb_first, false, page_growth<64>> paged(256);
+
+    exact.push_back(true);
+    geometric.push_back(true);
+    paged.push_back(true);
+    REQUIRE( exact.capacity() == 320 );
+    REQUIRE( geometric.capacity() == 448 );
+    REQUIRE( paged.capacity() == 512 );
+
+    exact.insert(exact.begin(), 1000, false);
+    REQUIRE( exact.capacity() == 1280 );
+    REQUIRE( exact.popcount() == 1 );
+    REQUIRE( exact.back() );
+}
+
+#ifdef DB_OS_LINUX
+template<typename T>
+struct remap_counting_allocator : mmap_allocator<T>
+{
+    template<typename U>
+    struct rebind { using other = remap_counting_allocator<U>; };
+
+    static inline size_t remaps = 0;
+
+    remap_counting_allocator() = default;
+    template<typename U>
+    remap_counting_allocator(remap_counting_allocator<U> const&) {}
+
+    T* try_reallocate(T* p, size_t n, size_t new_n) noexcept
+    {
+        ++remap_counting_allocator<std::byte>::remaps;
+        return mmap_allocator<T>::try_reallocate(p, n, new_n);
+    }
+};
+
+TEST_CASE("in place expansion", "[DynamicBitset]") {
+    DynamicBitset<remap_counting_allocator<std::byte>, uint64_t, 8, lsb_first, false, page_growth<>> v;
+    DynamicBitset<mmap_allocator<std::byte>> sparse(size_t(1) << 30);
+    sparse[123456789] = true;
+    REQUIRE( sparse.popcount() == 1 );
+
+    for(size_t i = 0; i < 1000000; ++i)
+        v.push_back(i % 7 == 0);
+
+    REQUIRE( remap_counting_allocator<std::byte>::remaps > 0 );
+    REQUIRE( v.popcount() == 142858 );
+    for(size_t i = 0; i < v.size(); i += 997)
+        REQUIRE( v[i] == (i % 7 == 0) );
+}
+#endif
+
+TEST_CASE("zeroed allocation", "[DynamicBitset]") {
+    using bitset = DynamicBitset<zeroing_allocator<std::byte>>;
+    zeroing_allocator<std::byte>::zeroed = 0;
+
+    bitset v(10000);
+    REQUIRE( zeroing_allocator<std::byte>::zeroed == 1 );
+    REQUIRE( v.none() );
+
+    SECTION( "assign and resize from empty use fresh zeroed storage" ) {
+        v.assign(20000, false);
+        REQUIRE( zeroing_allocator<std::byte>::zeroed == 2 );
+        REQUIRE( v.none() );
+
+        bitset w;
+        w.resize(5000);
+        REQUIRE( zeroing_allocator<std::byte>::zeroed == 3 );
+        REQUIRE( w.none() );
+    }
+    SECTION( "ones and growth still clear what they expose" ) {
+        bitset w(300, true);
+        REQUIRE( w.popcount() == 300 );
+        w.resize(5000);
+        REQUIRE( w.popcount() == 300 );
+        v.push_back(true);
+        v.resize(50000);
+        REQUIRE( v.popcount() == 1 );
+    }
+}
+
+TEST_CASE("calloc allocator", "[DynamicBitset]") {
+    DynamicBitset<calloc_allocator<std::byte>> v(1 << 20);
+    REQUIRE( v.none() );
+    v[12345] = true;
+    v.resize(1 << 21, true);
+    REQUIRE( v.popcount() == (1 << 20) + 1 );
+}
+
+TEST_CASE("polymorphic allocators", "[DynamicBitset]") {
+    std::byte buffer[1 << 13];
+    std::byte other_buffer[1 << 13];
+    std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+    std::pmr::monotonic_buffer_resource other_arena(other_buffer, sizeof(other_buffer), std::pmr::null_memory_resource());
+
+    pmr::DynamicBitset<> v(A126, &arena);
+    v.resize(2000, true);
+    REQUIRE( v.get_allocator().resource() == &arena );
+    REQUIRE( v.popcount() == 126 + 2000 - std::size(A126) );
+
+    SECTION( "copies use the default resource unless given one" ) {
+        pmr::DynamicBitset<> copy(v);
+        REQUIRE( copy.get_allocator().resource() == std::pmr::get_default_resource() );
+        pmr::DynamicBitset<> extended(v, &arena);
+        REQUIRE( extended.get_allocator().resource() == &arena );
+        REQUIRE( extended == v );
+    }
+    SECTION( "assignments keep the resource of the target" ) {
+        pmr::DynamicBitset<> w(&other_arena);
+        w = v;
+        REQUIRE( w.get_allocator().resource() == &other_arena );
+        REQUIRE( w == v );
+
+        pmr::DynamicBitset<> x(10, false, &other_arena);
+        x = std::move(v);
+        REQUIRE( x.get_allocator().resource() == &other_arena );
+        REQUIRE( x == w );
+
+        pmr::DynamicBitset<> moved(std::move(x), &arena);
+        REQUIRE( moved.get_allocator().resource() == &arena );
+        REQUIRE( moved == w );
+    }
+    SECTION( "copy on write only shares within a resource" ) {
+        pmr::DynamicBitset<uint64_t, 8, lsb_first, true> a(3000, true, &arena);
+        pmr::DynamicBitset<uint64_t, 8, lsb_first, true> b(a, &arena);
+        pmr::DynamicBitset<uint64_t, 8, lsb_first, true> c(a, &other_arena);
+        REQUIRE( std::as_const(b).begin() == std::as_const(a).begin() );
+        REQUIRE( std::as_const(c).begin() != std::as_const(a).begin() );
+        REQUIRE( c.popcount() == 3000 );
+    }
+}
+
+TEMPLATE_TEST_CASE("bitwise assignments", "[DynamicBitset]", uint8_t, uint64_t) {
+    using bitset = DynamicBitset<std::allocator<std::byte>, TestType>;
+
+    for(size_t lhs_size : {0, 5, 64, 777, 2048})
+        for(size_t rhs_size : {0, 3, 777, 1500})
+        {
+            const std::vector<bool> lhs = pattern(lhs_size, 1), rhs = pattern(rhs_size, 2);
+            const bitset a(lhs.begin(), lhs.end()), b(rhs.begin(), rhs.end());
+
+            bitset and_ = a, or_ = a, xor_ = a, diff = a, nand = a, nor = a, xnor = a;
+            and_ &= b;
+            or_ |= b;
+            xor_ ^= b;
+            diff -= b;
+            nand.nand(b);
+            nor.nor(b);
+            xnor.xnor(b);
+            REQUIRE( and_.size() == lhs_size );
+            REQUIRE( or_.size() == lhs_size );
+            REQUIRE( nand.size() == lhs_size );
+            for(size_t i = 0; i < lhs_size; ++i)
+            {
+                const bool r = i < rhs_size && rhs[i];
+                REQUIRE( and_[i] == (lhs[i] && r) );
+                REQUIRE( or_[i] == (lhs[i] || r) );
+                REQUIRE( xor_[i] == (lhs[i] != r) );
+                REQUIRE( diff[i] == (lhs[i] && !r) );
+                REQUIRE( nand[i] == !(lhs[i] && r) );
+                REQUIRE( nor[i] == !(lhs[i] || r) );
+                REQUIRE( xnor[i] == (lhs[i] == r) );
+            }
+            REQUIRE( bitset(a - b) == diff );
+            for(bitset* x : {&or_, &xor_, &nand, &nor, &xnor})
+            {
+                const size_t count = size_t(std::count(x->begin(), x->end(), true));
+                x->resize(lhs_size + 300);
+                REQUIRE( x->popcount() == count );
+            }
+        }
+
+    bitset self(A126);
+    self.xnor(self);
+    REQUIRE( self.popcount() == self.size() );
+    self.and_not(self);
+    REQUIRE( self.none() );
+}
+
+#ifdef DB_SIMD_DISPATCH
+TEST_CASE("word kernels", "[DynamicBitset]") {
+    using namespace detail::simd;
+    std::vector<std::tuple<binary_kernel, binary_kernel, bool>> kernels = {
+        {&binary_scalar<xor_op>, &binary_scalar<nand_op>, true},
+        {&binary_sse2<xor_op>, &binary_sse2<nand_op>, bool(__builtin_cpu_supports("sse2"))},
+        {&binary_avx2<xor_op>, &binary_avx2<nand_op>, bool(__builtin_cpu_supports("avx2"))},
+        {&binary_avx512<xor_op>, &binary_avx512<nand_op>, bool(__builtin_cpu_supports("avx512f"))},
+    };
+
+    for(auto [kernel, nand, supported] : kernels)
+    {
+        if(!supported)
+            continue;
+        for(size_t n : {0, 1, 15, 16, 33, 64, 127, 1000})
+        {
+            std::vector<std::byte> a(n), b(n);
+            for(size_t i = 0; i < n; ++i)
+            {
+                a[i] = std::byte(i * 37);
+                b[i] = std::byte(i * 91 + 5);
+            }
+            std::vector<std::byte> expected(n);
+            for(size_t i = 0; i < n; ++i)
+                expected[i] = a[i] ^ b[i];
+            kernel(a.data(), b.data(), n);
+            REQUIRE( a == expected );
+            for(size_t i = 0; i < n; ++i)
+                expected[i] = ~(a[i] & b[i]);
+            nand(a.data(), b.data(), n);
+            REQUIRE( a == expected );
+        }
+    }
+
+    std::vector<std::pair<popcount_kernel, bool>> popcounts = {
+        {&popcount_scalar, true},
+        {&popcount_popcnt, bool(__builtin_cpu_supports("popcnt"))},
+        {&popcount_avx2, bool(__builtin_cpu_supports("avx2"))},
+        {&popcount_avx512, bool(__builtin_cpu_supports("avx512vpopcntdq"))},
+    };
+    for(auto [kernel, supported] : popcounts)
+    {
+        if(!supported)
+            continue;
+        for(size_t n : {0, 1, 31, 32, 511, 512, 1000, 4103})
+        {
+            std::vector<std::byte> a(n);
+            size_t expected = 0;
+            for(size_t i = 0; i < n; ++i)
+            {
+                a[i] = std::byte(i * 37 + i / 7);
+                expected += std::bitset<8>(uint8_t(a[i])).count();
+            }
+            REQUIRE( kernel(a.data(), n) == expected );
+            // Saturated counters of the adder tree
+            std::fill(a.begin(), a.end(), std::byte(0xFF));
+            REQUIRE( kernel(a.data(), n) == 8 * n );
+        }
+    }
+
+    std::vector<std::pair<binary_popcount_kernel, bool>> binary_popcounts = {
+        {&binary_popcount_scalar<and_not_op>, true},
+        {&binary_popcount_popcnt<and_not_op>, bool(__builtin_cpu_supports("popcnt"))},
+        {&binary_popcount_avx2<and_not_op>, bool(__builtin_cpu_supports("avx2"))},
+        {&binary_popcount_avx512<and_not_op>, bool(__builtin_cpu_supports("avx512vpopcntdq"))},
+    };
+    for(auto [kernel, supported] : binary_popcounts)
+    {
+        if(!supported)
+            continue;
+        for(size_t n : {0, 1, 31, 32, 511, 512, 1000, 4103})
+        {
+            std::vector<std::byte> a(n), b(n);
+            size_t expected = 0;
+            for(size_t i = 0; i < n; ++i)
+            {
+                a[i] = std::byte(i * 37 + i / 7);
+                b[i] = std::byte(i * 91 + 5);
+                expected += std::bitset<8>(uint8_t(a[i] & ~b[i])).count();
+            }
+            REQUIRE( kernel(a.data(), b.data(), n) == expected );
+        }
+    }
+
+    std::vector<std::pair<binary_popcount_pair_kernel, bool>> binary_popcount_pairs = {
+        {&binary_popcount_pair_scalar<and_op, or_op>, true},
+        {&binary_popcount_pair_popcnt<and_op, or_op>, bool(__builtin_cpu_supports("popcnt"))},
+        {&binary_popcount_pair_avx2<and_op, or_op>, bool(__builtin_cpu_supports("avx2"))},
+        {&binary_popcount_pair_avx512<and_op, or_op>, bool(__builtin_cpu_supports("avx512vpopcntdq"))},
+    };
+    for(auto [kernel, supported] : binary_popcount_pairs)
+    {
+        if(!supported)
+            continue;
+        for(size_t n : {0, 1, 31, 32, 255, 256, 1000, 4103})
+        {
+            std::vector<std::byte> a(n), b(n);
+            size_t both = 0, either = 0, in_b = 0;
+            for(size_t i = 0; i < n; ++i)
+            {
+                a[i] = std::byte(i * 37 + i / 7);
+                b[i] = std::byte(i * 91 + 5);
+                both += std::bitset<8>(uint8_t(a[i] & b[i])).count();
+                either += std::bitset<8>(uint8_t(a[i] | b[i])).count();
+                in_b += std::bitset<8>(uint8_t(b[i])).count();
+            }
+            REQUIRE( kernel(a.data(), b.data(), n) == std::array<size_t, 2>{both, either} );
+            // Saturated counters of both adder trees
+            std::fill(a.begin(), a.end(), std::byte(0xFF));
+            REQUIRE( kernel(a.data(), b.data(), n) == std::array<size_t, 2>{in_b, 8 * n} );
+        }
+    }
+
+    std::vector<std::tuple<shift_kernel, shift_kernel, bool>> shifts = {
+        {&shift_scalar<true>, &shift_scalar<false>, true},
+        {&shift_sse2<true>, &shift_sse2<false>, bool(__builtin_cpu_supports("sse2"))},
+        {&shift_avx2<true>, &shift_avx2<false>, bool(__builtin_cpu_supports("avx2"))},
+        {&shift_avx512<true>, &shift_avx512<false>, bool(__builtin_cpu_supports("avx512f"))},
+    };
+    for(auto [up, down, supported] : shifts)
+    {
+        if(!supported)
+            continue;
+        for(size_t n : {1, 7, 8, 30, 100, 301})
+            for(size_t shift : {0, 1, 9, 63, 64, 65, 200, 1000, 2407})
+            {
+                if(shift >= 8 * n)
+                    continue;
+                std::vector<std::byte> a(n);
+                for(size_t i = 0; i < n; ++i)
+                    a[i] = std::byte(i * 37 + i / 7 + 1);
+                const auto bit = [&a](size_t i) { return (uint8_t(a[i / 8]) >> (i % 8)) & 1; };
+                std::vector<std::byte> left(a), right(a);
+                up(left.data(), n, shift);
+                down(right.data(), n, shift);
+                for(size_t i = 0; i < 8 * n; ++i)
+                {
+                    REQUIRE( ((uint8_t(left[i / 8]) >> (i % 8)) & 1) == (i >= shift ? bit(i - shift) : 0) );
+                    REQUIRE( ((uint8_t(right[i / 8]) >> (i % 8)) & 1) == (i + shift < 8 * n ? bit(i + shift) : 0) );
+                }
+            }
+    }
+}
+#endif
+
+TEST_CASE("bitwise expressions", "[DynamicBitset]") {
+    const size_t n = 1000;
+    std::vector<bool> ra(n), rb(n), rc(n - 300);
+    for(size_t i = 0; i < n; ++i)
+    {
+        ra[i] = i % 3 == 0;
+        rb[i] = i % 5 < 2;
+    }
+    for(size_t i = 0; i < rc.size(); ++i)
+        rc[i] = i % 7 == 1;
+    DynamicBitset<> a(ra.begin(), ra.end()), b(rb.begin(), rb.end()), c(rc.begin(), rc.end());
+
+    DynamicBitset<> r = (a & b) | ~c;
+    REQUIRE( r.size() == n );
+    for(size_t i = 0; i < n; ++i)
+        REQUIRE( r[i] == ((ra[i] && rb[i]) || !(i < rc.size() && rc[i])) );
+
+    SECTION( "operands size the result from the left" ) {
+        DynamicBitset<> s = ~c ^ a;
+        REQUIRE( s.size() == c.size() );
+        for(size_t i = 0; i < c.size(); ++i)
+            REQUIRE( s[i] == (!rc[i] != ra[i]) );
+        s = ~c;
+        REQUIRE( s.popcount() == c.size() - c.popcount() );
+    }
+    SECTION( "the destination may appear in the expression" ) {
+        c = a & (c | b);
+        REQUIRE( c.size() == n );
+        for(size_t i = 0; i < n; ++i)
+            REQUIRE( c[i] == (ra[i] && ((i < rc.size() && rc[i]) || rb[i])) );
+
+        DynamicBitset<> expected = a ^ (b & ~a);
+        a ^= b & ~a;
+        REQUIRE( a == expected );
+        a &= ~a;
+        REQUIRE( a.none() );
+    }
+    SECTION( "shifts are expressions too" ) {
+        using counted = DynamicBitset<counting_allocator<std::byte>>;
+        const counted x(ra.begin(), ra.end()), y(rb.begin(), rb.end());
+        counted z(n);
+        const size_t allocations = counting_allocator<std::byte>::allocations;
+        z = (x << 70) & y;
+        z |= (x >> 3) ^ ~(y << 1);
+        REQUIRE( counting_allocator<std::byte>::allocations == allocations );
+        for(size_t i = 0; i < n; ++i)
+            REQUIRE( z[i] == ((i >= 70 && ra[i - 70] && rb[i]) || ((i + 3 < n && ra[i + 3]) != !(i >= 1 && rb[i - 1]))) );
+
+        // The padding of a complement is not shifted in
+        DynamicBitset<> s = ~c >> 3;
+        REQUIRE( s.size() == c.size() );
+        for(size_t i = 0; i < c.size(); ++i)
+            REQUIRE( s[i] == (i + 3 < c.size() && !rc[i + 3]) );
+        s = (~c << 5) >> 5;
+        REQUIRE( s.popcount() == c.size() - 5 - DynamicBitset<>(c << 5).popcount() );
+
+        // In place, in either direction or both
+        counted w = x;
+        w = w >> 129;
+        w = w << 129 | w;
+        REQUIRE( counting_allocator<std::byte>::allocations == allocations + 1 );
+        w = w << 1 | w >> 1;
+        REQUIRE( counting_allocator<std::byte>::allocations == allocations + 2 );
+        const auto shifted = [](std::vector<bool> const& v, ptrdiff_t k) {
+            std::vector<bool> r(v.size());
+            for(size_t i = 0; i < v.size(); ++i)
+                r[i] = ptrdiff_t(i) - k >= 0 && size_t(ptrdiff_t(i) - k) < v.size() && v[i - k];
+            return r;
+        };
+        std::vector<bool> rw = shifted(ra, -129), up = shifted(rw, 129);
+        for(size_t i = 0; i < n; ++i)
+            rw[i] = rw[i] || up[i];
+        up = shifted(rw, 1);
+        const std::vector<bool> down = shifted(rw, -1);
+        for(size_t i = 0; i < n; ++i)
+            REQUIRE( w[i] == (up[i] || down[i]) );
+    }
+    SECTION( "copy on write destinations detach" ) {
+        using cow = DynamicBitset<std::allocator<std::byte>, uint64_t, alignof(uint64_t), lsb_first, true>;
+        cow x(ra.begin(), ra.end());
+        cow y = x;
+        y = ~y;
+        REQUIRE( x.popcount() == a.popcount() );
+        REQUIRE( y.popcount() == n - a.popcount() );
+        REQUIRE( (x & y).size() == n );
+        REQUIRE( cow(x & y).none() );
+    }
+}
+
+TEST_CASE("ternary functions", "[DynamicBitset]") {
+    const size_t n = 1000;
+    std::vector<bool> ra(n), rb(n), rc(n - 300);
+    for(size_t i = 0; i < n; ++i)
+    {
+        ra[i] = i % 3 == 0;
+        rb[i] = i % 5 < 2;
+    }
+    for(size_t i = 0; i < rc.size(); ++i)
+        rc[i] = i % 7 == 1;
+    const DynamicBitset<> a(ra.begin(), ra.end()), b(rb.begin(), rb.end()), c(rc.begin(), rc.end());
+
+    DynamicBitset<> r;
+    for(unsigned table = 0; table < 256; ++table)
+    {
+        apply3(r, a, b, c, uint8_t(table));
+        REQUIRE( r.size() == n );
+        for(size_t i = 0; i < n; ++i)
+        {
+            const unsigned index = ra[i] << 2 | rb[i] << 1 | (i < rc.size() && rc[i]);
+            REQUIRE( r[i] == bool(table >> index & 1) );
+        }
+    }
+
+    SECTION( "truth tables compose" ) {
+        apply3(r, a, b, c, truth_table::a & truth_table::b | uint8_t(~truth_table::c));
+        REQUIRE( r == DynamicBitset<>((a & b) | ~c) );
+    }
+    SECTION( "the destination may be an operand" ) {
+        DynamicBitset<> x = c;
+        apply3(x, a, b, x, truth_table::a ^ truth_table::b ^ truth_table::c);
+        REQUIRE( x == DynamicBitset<>(a ^ b ^ c) );
+        DynamicBitset<> y = a;
+        apply3(y, y, b, c, truth_table::b);
+        REQUIRE( y == b );
+    }
+    SECTION( "copy on write destinations detach" ) {
+        using cow = DynamicBitset<std::allocator<std::byte>, uint64_t, alignof(uint64_t), lsb_first, true>;
+        cow x(ra.begin(), ra.end()), y(rb.begin(), rb.end());
+        cow z = x;
+        apply3(z, x, y, y, truth_table::a & truth_table::b);
+        REQUIRE( x.popcount() == a.popcount() );
+        REQUIRE( z.popcount() == DynamicBitset<>(a & b).popcount() );
+    }
+
+#ifdef DB_SIMD_DISPATCH
+    SECTION( "word kernels agree" ) {
+        using namespace detail::simd;
+        std::vector<std::pair<ternary_kernel, bool>> kernels = {
+            {&ternary_sse2<>, bool(__builtin_cpu_supports("sse2"))},
+            {&ternary_avx2<>, bool(__builtin_cpu_supports("avx2"))},
+            {&ternary_avx512<>, bool(__builtin_cpu_supports("avx512f"))},
+        };
+        const size_t bytes = 200;
+        std::vector<std::byte> x(bytes), y(bytes), z(bytes), expected(bytes), out(bytes);
+        for(size_t i = 0; i < bytes; ++i)
+        {
+            x[i] = std::byte(i * 37);
+            y[i] = std::byte(i * 91 + 5);
+            z[i] = std::byte(i * 13 + 101);
+        }
+        for(auto [kernel, supported] : kernels)
+        {
+            if(!supported)
+                continue;
+            for(unsigned table = 0; table < 256; ++table)
+            {
+                ternary_scalar(expected.data(), x.data(), y.data(), z.data(), bytes, uint8_t(table));
+                kernel(out.data(), x.data(), y.data(), z.data(), bytes, uint8_t(table));
+                REQUIRE( out == expected );
+            }
+        }
+    }
+#endif
+}
+
+TEMPLATE_TEST_CASE("fused counts", "[DynamicBitset]", uint8_t, uint64_t) {
+    using bitset = DynamicBitset<std::allocator<std::byte>, TestType>;
+
+    for(size_t lhs_size : {0, 5, 777, 2048})
+        for(size_t rhs_size : {0, 3, 777, 1500})
+        {
+            const std::vector<bool> lhs = pattern(lhs_size, 3), rhs = pattern(rhs_size, 4);
+            const bitset a(lhs.begin(), lhs.end()), b(rhs.begin(), rhs.end());
+
+            size_t both = 0, either = 0, only_a = 0, one = 0;
+            for(size_t i = 0; i < std::max(lhs_size, rhs_size); ++i)
+            {
+                const bool x = i < lhs_size && lhs[i], y = i < rhs_size && rhs[i];
+                both += x && y;
+                either += x || y;
+                only_a += x && !y;
+                one += x != y;
+            }
+            REQUIRE( intersection_count(a, b) == both );
+            REQUIRE( union_count(a, b) == either );
+            REQUIRE( difference_count(a, b) == only_a );
+            REQUIRE( difference_count(b, a) == one - only_a );
+            REQUIRE( symmetric_difference_count(a, b) == one );
+            REQUIRE( jaccard(a, b) == (either == 0 ? 1.0 : double(both) / double(either)) );
+        }
+
+    const bitset a(A126);
+    REQUIRE( jaccard(a, a) == 1.0 );
+    REQUIRE( intersection_count(a, bitset(~a)) == 0 );
+}
+
+TEMPLATE_TEST_CASE("shifts", "[DynamicBitset]", lsb_first, msb_first) {
+    using bitset = DynamicBitset<std::allocator<std::byte>, uint8_t, alignof(uint8_t), TestType>;
+    using wide_bitset = DynamicBitset<std::allocator<std::byte>, uint64_t, alignof(uint64_t), TestType>;
+
+    for(size_t size : {0, 1, 7, 64, 130, 1000})
+        for(size_t n : {0, 1, 3, 8, 63, 64, 65, 129, 999, 1000, 5000})
+        {
+            const std::vector<bool> ref = pattern(size, 5);
+            const bitset a(ref.begin(), ref.end());
+            const wide_bitset w(ref.begin(), ref.end());
+
+            const bitset left = a << n, right = a >> n;
+            const wide_bitset wide_left = w << n, wide_right = w >> n;
+            REQUIRE( left.size() == size );
+            REQUIRE( right.size() == size );
+            size_t left_count = 0, right_count = 0;
+            for(size_t i = 0; i < size; ++i)
+            {
+                const bool l = i >= n && ref[i - n];
+                const bool r = n < size - i && ref[i + n];
+                left_count += l;
+                right_count += r;
+                REQUIRE( left[i] == l );
+                REQUIRE( right[i] == r );
+                REQUIRE( wide_left[i] == l );
+                REQUIRE( wide_right[i] == r );
+            }
+            REQUIRE( left.popcount() == left_count );
+            REQUIRE( wide_left.popcount() == left_count );
+            REQUIRE( right.popcount() == right_count );
+        }
+
+    // Subset sums : one pass per item, without a temporary
+    DynamicBitset<counting_allocator<std::byte>, uint64_t, alignof(uint64_t), TestType> dp(300);
+    dp[0] = true;
+    const size_t allocations = counting_allocator<std::byte>::allocations;
+    for(size_t w : {3, 5, 7, 200})
+        dp |= dp << w;
+    REQUIRE( counting_allocator<std::byte>::allocations == allocations );
+    REQUIRE( dp.popcount() == 16 );
+    REQUIRE( dp[15] );
+    REQUIRE( dp[215] );
+    REQUIRE( !dp[201] );
+}
+
+TEMPLATE_TEST_CASE("rotations", "[DynamicBitset]", lsb_first, msb_first) {
+    using bitset = DynamicBitset<std::allocator<std::byte>, uint16_t, alignof(uint16_t), TestType>;
+
+    // Whole-block sizes rotate by word cycles, 96 bits giving 6 words and cycles of 2 and 3 words
+    for(size_t size : {0, 1, 15, 16, 33, 96, 300})
+    {
+        const std::vector<bool> ref = pattern(size, 6);
+
+        for(size_t n : {0, 1, 5, 16, 17, 32, 48, 64, 71, 299, 301})
+        {
+            bitset left(ref.begin(), ref.end()), right(ref.begin(), ref.end());
+            left.rotate_left(n);
+            right.rotate_right(n);
+            REQUIRE( left.size() == size );
+            for(size_t i = 0; i < size; ++i)
+            {
+                REQUIRE( left[(i + n) % size] == ref[i] );
+                REQUIRE( right[i] == ref[(i + n) % size] );
+            }
+        }
+
+        for(size_t first = 0; first <= size; first += 7)
+            for(size_t middle = first; middle <= size; middle += 11)
+                for(size_t last = middle; last <= size; last += 13)
+                {
+                    bitset b(ref.begin(), ref.end());
+                    std::vector<bool> expected = ref;
+                    const auto it = b.rotate(b.cbegin() + first, b.cbegin() + middle, b.cbegin() + last);
+                    std::rotate(expected.begin() + first, expected.begin() + middle, expected.begin() + last);
+                    REQUIRE( it - b.begin() == std::ptrdiff_t(first + last - middle) );
+                    REQUIRE( std::equal(b.begin(), b.end(), expected.begin(), expected.end()) );
+                }
+    }
+}
+
+TEMPLATE_TEST_CASE("comparisons", "[DynamicBitset]", lsb_first, msb_first) {
+    using bitset = DynamicBitset<std::allocator<std::byte>, uint32_t, alignof(uint32_t), TestType>;
+
+    std::vector<std::vector<bool>> refs;
+    for(size_t size : {0, 1, 31, 32, 33, 100})
+    {
+        const std::vector<bool> ref = pattern(size, 7);
+        refs.push_back(ref);
+        for(size_t i : {size_t(0), size / 2, size - 1})
+            if(i < size)
+            {
+                std::vector<bool> flipped = ref;
+                flipped[i] = !flipped[i];
+                refs.push_back(flipped);
+            }
+    }
+
+    for(auto const& x : refs)
+        for(auto const& y : refs)
+        {
+            const bitset a(x.begin(), x.end()), b(y.begin(), y.end());
+            REQUIRE( (a == b) == (x == y) );
+            REQUIRE( (a != b) == (x != y) );
+            REQUIRE( (a < b) == (x < y) );
+            REQUIRE( (a <= b) == (x <= y) );
+            REQUIRE( (a > b) == (x > y) );
+            REQUIRE( (a >= b) == (x >= y) );
+#ifdef __cpp_lib_three_way_comparison
+            REQUIRE( (a <=> b) == (x <=> y) );
+#endif
+        }
+}
+
+TEST_CASE("hashing", "[DynamicBitset]") {
+    using bitset = DynamicBitset<std::allocator<std::byte>, uint8_t>;
+    const std::hash<bitset> hash;
+
+    bitset a(A126), b(A126);
+    REQUIRE( hash(a) == hash(b) );
+    b.flip(100);
+    REQUIRE( hash(a) != hash(b) );
+    // Equal contents, the padding excluded, and sizes salted in
+    b = a;
+    b.push_back(false);
+    b.pop_back();
+    REQUIRE( hash(a) == hash(b) );
+    REQUIRE( hash(bitset(10)) != hash(bitset(11)) );
+
+    std::unordered_set<bitset> seen;
+    for(size_t i = 0; i < 200; ++i)
+    {
+        bitset x(200);
+        x[i] = true;
+        seen.insert(x);
+        seen.insert(x);
+    }
+    REQUIRE( seen.size() == 200 );
+
+    SECTION( "chunk sums" ) {
+        // The unrolled sum over whole words, then the tail, agrees with the single-chunk mixes
+        std::byte bytes[77];
+        for(size_t i = 0; i < sizeof(bytes); ++i)
+            bytes[i] = std::byte(i * 37 + 11);
+        for(size_t n : {0, 1, 7, 8, 13, 32, 45, 77})
+        {
+            uint64_t sum = 0;
+            for(size_t j = 0; j * 8 < n; ++j)
+                sum ^= detail::hash_chunk(bytes, n, j);
+            REQUIRE( detail::hash_chunks(bytes, n) == sum );
+            REQUIRE( detail::hash_chunk(bytes, n, (n + 7) / 8) == 0 );
+        }
+    }
+
+    SECTION( "incremental" ) {
+        bitset c(A126);
+        incremental_hash<bitset> h(c);
+        REQUIRE( h.value() == incremental_hash<bitset>::of(a) );
+        REQUIRE( h.value() == hash(a) );
+        h.flip(3);
+        h.set(70);
+        h.reset(71);
+        h.push_back(true);
+        h.push_back(false);
+        h.pop_back();
+        REQUIRE( &h.bitset() == &c );
+        REQUIRE( h.value() == incremental_hash<bitset>::of(c) );
+        REQUIRE( h.value() == hash(c) );
+        h.pop_back();
+        h.set(70, a[70]);
+        h.set(71, a[71]);
+        h.flip(3);
+        REQUIRE( c == a );
+        REQUIRE( h.value() == incremental_hash<bitset>::of(a) );
+        REQUIRE( h.value() != incremental_hash<bitset>::of(bitset(a.size())) );
+
+        // Pushes across chunk boundaries, from an empty bitset
+        bitset d;
+        incremental_hash<bitset> g(d);
+        for(size_t i = 0; i < 200; ++i)
+        {
+            g.push_back(i % 3 == 0);
+            REQUIRE( g.value() == hash(d) );
+        }
+        while(!d.empty())
+        {
+            g.pop_back();
+            REQUIRE( g.value() == hash(d) );
+        }
+    }
+}
+
+TEMPLATE_TEST_CASE("find set bits", "[DynamicBitset]", lsb_first, msb_first) {
+    using bitset = DynamicBitset<std::allocator<std::byte>, uint64_t, alignof(uint64_t), TestType>;
+    using narrow_bitset = DynamicBitset<std::allocator<std::byte>, uint8_t, alignof(uint8_t), TestType>;
+
+    REQUIRE( bitset().find_first() == bitset::npos );
+    REQUIRE( bitset(1000).find_first() == bitset::npos );
+    REQUIRE( bitset(1000).find_next(5) == bitset::npos );
+
+    for(size_t stride : {1, 3, 64, 700, 1000, 5000})
+    {
+        const size_t n = 10000;
+        std::vector<bool> ref(n);
+        for(size_t i = stride / 2; i < n; i += stride)
+            ref[i] = true;
+        const bitset a(ref.begin(), ref.end());
+        const narrow_bitset b(ref.begin(), ref.end());
+
+        std::vector<size_t> expected, found, narrow_found;
+        for(size_t i = 0; i < n; ++i)
+            if(ref[i])
+                expected.push_back(i);
+        for(size_t i = a.find_first(); i != bitset::npos; i = a.find_next(i))
+            found.push_back(i);
+        for(size_t i = b.find_first(); i != narrow_bitset::npos; i = b.find_next(b.cbegin() + i))
+            narrow_found.push_back(i);
+        REQUIRE( found == expected );
+        REQUIRE( narrow_found == expected );
+
+        std::vector<size_t> backward, narrow_backward;
+        for(size_t i = a.find_last(); i != bitset::npos; i = a.find_prev(i))
+            backward.push_back(i);
+        for(size_t i = b.find_last(); i != narrow_bitset::npos; i = b.find_prev(b.cbegin() + i))
+            narrow_backward.push_back(i);
+        std::reverse(expected.begin(), expected.end());
+        REQUIRE( backward == expected );
+        REQUIRE( narrow_backward == expected );
+    }
+
+    bitset last(130);
+    last[129] = true;
+    REQUIRE( last.find_first() == 129 );
+    REQUIRE( last.find_next(128) == 129 );
+    REQUIRE( last.find_next(129) == bitset::npos );
+    REQUIRE( last.find_next(500) == bitset::npos );
+    REQUIRE( last.find_last() == 129 );
+    REQUIRE( last.find_prev(129) == bitset::npos );
+    REQUIRE( last.find_prev(500) == 129 );
+    last[0] = true;
+    REQUIRE( last.find_prev(129) == 0 );
+    REQUIRE( last.find_prev(0) == bitset::npos );
+    REQUIRE( bitset().find_last() == bitset::npos );
+    REQUIRE( bitset(1000).find_last() == bitset::npos );
+}
+
+TEMPLATE_TEST_CASE("find zero bits", "[DynamicBitset]", lsb_first, msb_first) {
+    using bitset = DynamicBitset<std::allocator<std::byte>, uint64_t, alignof(uint64_t), TestType>;
+    using narrow_bitset = DynamicBitset<std::allocator<std::byte>, uint8_t, alignof(uint8_t), TestType>;
+
+    REQUIRE( bitset().find_first_zero() == bitset::npos );
+    REQUIRE( bitset(1000).find_first_zero() == 0 );
+    REQUIRE( bitset(1000).find_next_zero(5) == 6 );
+    // The zero padding is never found
+    REQUIRE( bitset(1000, true).find_first_zero() == bitset::npos );
+    REQUIRE( narrow_bitset(13, true).find_next_zero(3) == narrow_bitset::npos );
+
+    for(size_t stride : {1, 3, 64, 700, 1000, 5000})
+    {
+        const size_t n = 10003;
+        std::vector<bool> ref(n, true);
+        for(size_t i = stride / 2; i < n; i += stride)
+            ref[i] = false;
+        const bitset a(ref.begin(), ref.end());
+        const narrow_bitset b(ref.begin(), ref.end());
+
+        std::vector<size_t> expected, found, narrow_found;
+        for(size_t i = 0; i < n; ++i)
+            if(!ref[i])
+                expected.push_back(i);
+        for(size_t i = a.find_first_zero(); i != bitset::npos; i = a.find_next_zero(i))
+            found.push_back(i);
+        for(size_t i = b.find_first_zero(); i != narrow_bitset::npos; i = b.find_next_zero(b.cbegin() + i))
+            narrow_found.push_back(i);
+        REQUIRE( found == expected );
+        REQUIRE( narrow_found == expected );
+    }
+}
+
+#ifdef DB_SIMD_DISPATCH
+TEST_CASE("skipping kernels", "[DynamicBitset]") {
+    using namespace detail::simd;
+    // Kernels skipping zeros, then kernels skipping ones
+    std::vector<std::tuple<skip_kernel, bool, std::byte>> kernels = {
+        {&skip_scalar<0x00>, true, std::byte(0x00)},
+        {&skip_sse2<0x00>, bool(__builtin_cpu_supports("sse2")), std::byte(0x00)},
+        {&skip_avx2<0x00>, bool(__builtin_cpu_supports("avx2")), std::byte(0x00)},
+        {&skip_avx512<0x00>, bool(__builtin_cpu_supports("avx512f")), std::byte(0x00)},
+        {&skip_scalar<0xFF>, true, std::byte(0xFF)},
+        {&skip_sse2<0xFF>, bool(__builtin_cpu_supports("sse2")), std::byte(0xFF)},
+        {&skip_avx2<0xFF>, bool(__builtin_cpu_supports("avx2")), std::byte(0xFF)},
+        {&skip_avx512<0xFF>, bool(__builtin_cpu_supports("avx512f")), std::byte(0xFF)},
+    };
+    std::vector<std::pair<skip_kernel, bool>> backward_kernels = {
+        {&skip_zeros_backward_scalar, true},
+        {&skip_zeros_backward_sse2, bool(__builtin_cpu_supports("sse2"))},
+        {&skip_zeros_backward_avx2, bool(__builtin_cpu_supports("avx2"))},
+        {&skip_zeros_backward_avx512, bool(__builtin_cpu_supports("avx512f"))},
+    };
+    for(auto [kernel, supported] : backward_kernels)
+    {
+        if(!supported)
+            continue;
+        for(size_t n : {0, 1, 17, 64, 1000})
+        {
+            std::vector<std::byte> a(n);
+            REQUIRE( kernel(a.data(), n) == 0 );
+            for(size_t pos = 0; pos < n; pos += 7)
+            {
+                a[pos] = std::byte(0x10);
+                const size_t length = kernel(a.data(), n);
+                REQUIRE( pos < length );
+                REQUIRE( length <= pos + 64 );
+                a[pos] = std::byte(0);
+            }
+        }
+    }
+    for(auto [kernel, supported, skipped] : kernels)
+    {
+        if(!supported)
+            continue;
+        for(size_t n : {0, 1, 17, 64, 1000})
+        {
+            std::vector<std::byte> a(n, skipped);
+            REQUIRE( kernel(a.data(), n) == n );
+            for(size_t pos = 0; pos < n; pos += 7)
+            {
+                a[pos] = std::byte(0x10);
+                const size_t offset = kernel(a.data(), n);
+                REQUIRE( offset <= pos );
+                REQUIRE( pos < offset + 64 );
+                a[pos] = skipped;
+            }
+        }
+    }
+}
+#endif
+
+TEMPLATE_TEST_CASE("find runs", "[DynamicBitset]", lsb_first, msb_first) {
+    using bitset = DynamicBitset<std::allocator<std::byte>, uint64_t, alignof(uint64_t), TestType>;
+    using narrow_bitset = DynamicBitset<std::allocator<std::byte>, uint8_t, alignof(uint8_t), TestType>;
+
+    const auto naive = [](std::vector<bool> const& ref, bool value, size_t k, size_t from) {
+        if(k == 0)
+            return from <= ref.size() ? from : size_t(bitset::npos);
+        size_t run = 0;
+        for(size_t i = from; i < ref.size(); ++i)
+        {
+            run = ref[i] == value ? run + 1 : 0;
+            if(run >= k)
+                return i + 1 - k;
+        }
+        return size_t(bitset::npos);
+    };
+
+    // Occupancy maps with free extents of growing length
+    const size_t n = 3000;
+    std::vector<bool> ref(n, true);
+    for(size_t pos = 5, length = 1; pos + length < n; pos += length + 3, length = length * 3 / 2 + 1)
+        std::fill(ref.begin() + pos, ref.begin() + pos + length, false);
+    ref[n - 1] = false;
+    const bitset a(ref.begin(), ref.end());
+    const narrow_bitset b(ref.begin(), ref.end());
+    std::vector<bool> inverted(ref);
+    inverted.flip();
+    const bitset c(inverted.begin(), inverted.end());
+
+    for(size_t k : {0, 1, 2, 7, 8, 9, 63, 64, 65, 100, 500, 1000, 2000})
+        for(size_t from : {0, 1, 6, 64, 100, 1000, 2999, 3000, 3001})
+        {
+            REQUIRE( a.find_zero_run(k, from) == naive(ref, false, k, from) );
+            REQUIRE( a.find_one_run(k, from) == naive(ref, true, k, from) );
+            REQUIRE( b.find_zero_run(k, from) == naive(ref, false, k, from) );
+            REQUIRE( b.find_one_run(k, from) == naive(ref, true, k, from) );
+            REQUIRE( c.find_one_run(k, from) == naive(ref, false, k, from) );
+        }
+
+    REQUIRE( bitset(200).find_zero_run(200) == 0 );
+    REQUIRE( bitset(200).find_zero_run(201) == bitset::npos );
+    REQUIRE( bitset(200, true).find_zero_run(1) == bitset::npos );
+    REQUIRE( bitset(200, true).find_one_run(150, 50) == 50 );
+}
+
+TEMPLATE_TEST_CASE("set bit indices", "[DynamicBitset]", lsb_first, msb_first) {
+    using bitset = DynamicBitset<std::allocator<std::byte>, uint64_t, alignof(uint64_t), TestType>;
+    using narrow_bitset = DynamicBitset<std::allocator<std::byte>, uint8_t, alignof(uint8_t), TestType>;
+
+    REQUIRE( bitset().ones().empty() );
+    REQUIRE( bitset(1000).ones().empty() );
+
+    for(size_t stride : {1, 2, 63, 100, 1000})
+    {
+        const size_t n = 5000;
+        std::vector<bool> ref(n);
+        std::vector<size_t> expected;
+        for(size_t i = stride / 3; i < n; i += stride)
+        {
+            ref[i] = true;
+            expected.push_back(i);
+        }
+        const bitset a(ref.begin(), ref.end());
+        const narrow_bitset b(ref.begin(), ref.end());
+
+        std::vector<size_t> found;
+        for(size_t i : a.ones())
+            found.push_back(i);
+        REQUIRE( found == expected );
+        const auto view = b.ones();
+        REQUIRE( std::vector<size_t>(view.begin(), view.end()) == expected );
+        REQUIRE( size_t(std::distance(view.begin(), view.end())) == b.popcount() );
+    }
+}
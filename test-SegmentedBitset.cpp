@@ -0,0 +1,133 @@
+#include "catch.hpp"
+#include "SegmentedBitset.hpp"
+
+using namespace ok;
+
+// Small chunks, so that a few hundred bits already span several of them
+using segmented = SegmentedBitset<std::allocator<std::byte>, uint64_t, 256>;
+
+TEST_CASE("segmented growth", "[SegmentedBitset]") {
+    segmented v;
+    for(size_t i = 0; i < 1000; ++i)
+        v.push_back(i % 3 == 0);
+
+    REQUIRE( v.size() == 1000 );
+    REQUIRE( v.num_chunks() == 4 );
+    REQUIRE( v.popcount() == 334 );
+    for(size_t i = 0; i < v.size(); ++i)
+        REQUIRE( v[i] == (i % 3 == 0) );
+
+    SECTION( "growth does not move existing chunks" ) {
+        uint64_t const* first = v.chunk_blocks(0);
+        auto ref = v[5];
+        auto it = v.begin() + 254;
+        v.resize(100000, true);
+        REQUIRE( v.chunk_blocks(0) == first );
+        ref = true;
+        REQUIRE( v[5] );
+        REQUIRE( *it == false );
+        REQUIRE( *++it == true );
+        REQUIRE( v.popcount() == 335 + 99000 );
+    }
+    SECTION( "growth allocates the chunks it needs only" ) {
+        REQUIRE( v.capacity() == 4 * 256 );
+        v.resize(v.capacity() + 1);
+        REQUIRE( v.num_chunks() == 5 );
+        REQUIRE( v.capacity() == 5 * 256 );
+        v.resize(10 * 256);
+        REQUIRE( v.capacity() == 10 * 256 );
+        for(size_t i = 0; i < 256; ++i)
+            v.push_back(true);
+        REQUIRE( v.num_chunks() == 11 );
+        REQUIRE( v.capacity() == 11 * 256 );
+    }
+    SECTION( "iterators cross chunk boundaries" ) {
+        REQUIRE( std::distance(v.begin(), v.end()) == 1000 );
+        REQUIRE( size_t(std::count(v.cbegin(), v.cend(), true)) == 334 );
+        REQUIRE( size_t(std::count(v.rbegin(), v.rend(), true)) == 334 );
+        auto it = v.begin() + 250;
+        for(size_t i = 250; i < 270; ++i, ++it)
+            REQUIRE( *it == (i % 3 == 0) );
+    }
+    SECTION( "shrinking clears padding across chunks" ) {
+        v.resize(300);
+        v.flip();
+        REQUIRE( v.popcount() == 200 );
+        v.resize(700);
+        REQUIRE( v.popcount() == 200 );
+        v.clear();
+        v.resize(1000);
+        REQUIRE( v.none() );
+    }
+    SECTION( "copies and moves" ) {
+        segmented w(v);
+        REQUIRE( std::equal(v.begin(), v.end(), w.begin(), w.end()) );
+        segmented m(std::move(w));
+        REQUIRE( w.empty() );
+        REQUIRE( m.popcount() == 334 );
+        w = m;
+        m.pop_back();
+        swap(m, w);
+        REQUIRE( m.size() == 1000 );
+        REQUIRE( w.size() == 999 );
+    }
+}
+
+TEST_CASE("segmented bitwise operations", "[SegmentedBitset]") {
+    segmented a, b;
+    std::vector<bool> x, y;
+    for(size_t i = 0; i < 1000; ++i)
+    {
+        a.push_back(i % 3 == 0);
+        x.push_back(i % 3 == 0);
+    }
+    for(size_t i = 0; i < 700; ++i)
+    {
+        b.push_back(i % 5 < 2);
+        y.push_back(i % 5 < 2);
+    }
+    y.resize(1000, false);
+
+    SECTION( "operators run chunk by chunk" ) {
+        segmented r = a;
+        r &= b;
+        for(size_t i = 0; i < r.size(); ++i)
+            REQUIRE( r[i] == (x[i] && y[i]) );
+        r = a;
+        r |= b;
+        for(size_t i = 0; i < r.size(); ++i)
+            REQUIRE( r[i] == (x[i] || y[i]) );
+        r = a;
+        r ^= b;
+        for(size_t i = 0; i < r.size(); ++i)
+            REQUIRE( r[i] == (x[i] != y[i]) );
+        b |= a;
+        REQUIRE( b.size() == 700 );
+        REQUIRE( b.popcount() == size_t(std::count_if(b.begin(), b.end(), [](bool bit) { return bit; })) );
+    }
+    SECTION( "find crosses chunks" ) {
+        size_t count = 0;
+        for(size_t i = a.find_first(); i != segmented::npos; i = a.find_next(i), ++count)
+            REQUIRE( i == 3 * count );
+        REQUIRE( count == 334 );
+
+        segmented sparse(2000);
+        REQUIRE( sparse.find_first() == segmented::npos );
+        sparse[1999] = true;
+        sparse[700] = true;
+        REQUIRE( sparse.find_first() == 700 );
+        REQUIRE( sparse.find_next(700) == 1999 );
+        REQUIRE( sparse.find_next(1999) == segmented::npos );
+    }
+}
+
+TEST_CASE("segmented polymorphic allocators", "[SegmentedBitset]") {
+    std::pmr::monotonic_buffer_resource arena;
+    pmr::SegmentedBitset<uint64_t, 256> v(1000, true, &arena);
+    pmr::SegmentedBitset<uint64_t, 256> w(&arena);
+    w = v;
+    w.flip();
+    v = std::move(w);
+    REQUIRE( v.get_allocator().resource() == &arena );
+    REQUIRE( v.none() );
+}
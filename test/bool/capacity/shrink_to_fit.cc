@@ -23,7 +23,8 @@
 using namespace ok;
 TEST_CASE("01")
 {
-  DynamicBitset<> vb(__CHAR_BIT__ * sizeof(unsigned long) + 1);
+  // Large enough not to fit in the inline storage
+  DynamicBitset<> vb(__CHAR_BIT__ * sizeof(unsigned long) * 4 + 1);
   vb.pop_back();
 
   auto old_capacity = vb.capacity();
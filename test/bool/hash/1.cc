@@ -20,23 +20,25 @@
 #include "../../../DynamicBitset.hpp"
 #include <catch.hpp>
 
+using namespace ok;
+
 TEST_CASE("01")
 {
-  //DynamicBitset b0;
-  //std::hash<DynamicBitset<>>  h0;
-  //h0(b0);
-  //
-  //DynamicBitset b1(10);
-  //std::hash<DynamicBitset<>>  h1;
-  //h1(b1);
-  //
-  //DynamicBitset b2(100);
-  //std::hash<DynamicBitset<>>  h2;
-  //h2(b2);
-  //
-  //DynamicBitset b3(1000);
-  //std::hash<DynamicBitset<>>  h3;
-  //h3(b3);
+  DynamicBitset<> b0;
+  std::hash<DynamicBitset<>>  h0;
+  h0(b0);
+
+  DynamicBitset<> b1(10);
+  std::hash<DynamicBitset<>>  h1;
+  h1(b1);
+
+  DynamicBitset<> b2(100);
+  std::hash<DynamicBitset<>>  h2;
+  h2(b2);
+
+  DynamicBitset<> b3(1000);
+  std::hash<DynamicBitset<>>  h3;
+  h3(b3);
 }
 
 